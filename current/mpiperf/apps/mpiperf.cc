@@ -32,6 +32,12 @@
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
 #include <mpi.h>
 
 // ASKAPsoft includes
@@ -39,6 +45,17 @@
 #include "Common/ParameterSet.h"
 #include "casacore/casa/OS/Timer.h"
 
+// Local includes
+#include "ingest/LatencyHistogram.h"
+#include "ingest/SegmentWriter.h"
+#include "ingest/StripedWriter.h"
+#include "ingest/IngestQueue.h"
+#include "ingest/Pacer.h"
+#include "ingest/ShmRing.h"
+#include "ingest/HierarchicalGather.h"
+#include "ingest/Integrity.h"
+#include "ingest/Crc32c.h"
+
 #define BLOCKSIZE 4*1024*1024
 
 // Using
@@ -96,15 +113,1213 @@ void doWorkRoot(void *buffer, size_t buffsize, float *workTime,FILE *fptr) {
 
 
 }
-void doWorkWorker(void *buffer) {
 
+
+// The shape of the run, shared by the write modes
+struct Workload {
+    std::string filename;
+    int intTime;
+    int integrations;
+    int intPerFile;
+    int channels;
+    size_t nElements;
+    size_t sendBufferSize;
+    size_t recvBufferSize;
+    bool verbose;
+    Integrity* integrity;
+    bool readback;
+};
+
+// The correlator's part of an integration: with integrity checking on, a
+// synthetic payload for this rank and integration and the checksums of
+// its blocks
+void doWorkWorker(float *buffer, const Workload& w, int rank, int integration) {
+    if (w.integrity != NULL) {
+        w.integrity->generate(buffer, rank, integration);
+    }
+}
+
+// MPI-IO hints for the collective mode, from the mpiio.* parameters
+static MPI_Info makeInfo(const ParameterSet& subset)
+{
+    static const char* hints[] = { "cb_nodes", "cb_buffer_size", "romio_cb_write",
+        "romio_ds_write", "striping_factor", "striping_unit", 0 };
+
+    MPI_Info info;
+    MPI_Info_create(&info);
+    for (int i = 0; hints[i] != 0; ++i) {
+        const std::string key = std::string("mpiio.") + hints[i];
+        if (subset.isDefined(key)) {
+            MPI_Info_set(info, const_cast<char*>(hints[i]),
+                    const_cast<char*>(subset.getString(key).c_str()));
+        }
+    }
+    return info;
+}
+
+// Largest of a per-process time, valid on rank 0
+static double maxOverRanks(double t)
+{
+    double maxT = 0.0;
+    MPI_Reduce(&t, &maxT, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    return maxT;
+}
+
+// User and system CPU time of this process, all threads included
+static double cpuSeconds(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+        + 1E-6 * (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+// Start-time jitter, drift and overruns of every rank, printed by rank 0
+static void reportPacing(const Pacer& pacer, int rank)
+{
+    int wsize;
+    MPI_Comm_size(MPI_COMM_WORLD, &wsize);
+    double mine[5] = { pacer.jitter().mean(), pacer.jitter().percentile(99.0),
+        pacer.jitter().max(), pacer.drift(), static_cast<double>(pacer.late()) };
+    std::vector<double> all(5 * wsize);
+    MPI_Gather(mine, 5, MPI_DOUBLE, &all[0], 5, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        for (int r = 0; r < wsize; ++r) {
+            const double* v = &all[5 * r];
+            std::cout << "Rank " << r << " start jitter (s): mean " << v[0]
+                << ", p99 " << v[1] << ", max " << v[2] << ", final drift " << v[3]
+                << ", " << v[4] << " late" << std::endl;
+        }
+    }
+}
+
+// Cost of integrity checking against the integration time, and the blocks
+// that failed at the writer
+static void reportIntegrity(const Workload& w, const LatencyHistogram& verifyHist,
+        unsigned long bad, int rank, int wsize)
+{
+    const Integrity* check = w.integrity;
+    const double worst = maxOverRanks(check->generateTime().max() + check->checksumTime().max());
+    if (rank != 0) {
+        return;
+    }
+    std::cout << "Integrity: CRC32C (" << crc32cImplementation() << ") of "
+        << check->blocks() << " blocks of up to " << check->blockBytes()
+        << " bytes per rank" << std::endl;
+    check->generateTime().report(std::cout);
+    check->checksumTime().report(std::cout);
+    verifyHist.report(std::cout);
+    const double mbytes = static_cast<double>(w.sendBufferSize) / (1024.0 * 1024.0);
+    if (check->checksumTime().mean() > 0.0 && verifyHist.mean() > 0.0) {
+        std::cout << "Checksum rate: " << mbytes / check->checksumTime().mean()
+            << " MB/s per rank, verify rate " << wsize * mbytes / verifyHist.mean()
+            << " MB/s on rank 0" << std::endl;
+    }
+    std::cout << "Integrity cost per integration: " << 100.0 * check->checksumTime().mean() / w.intTime
+        << "% of the integration time per rank to checksum, "
+        << 100.0 * verifyHist.mean() / w.intTime << "% on rank 0 to verify ("
+        << 100.0 * worst / w.intTime << "% worst case for payload and checksum)" << std::endl;
+    if (bad > 0) {
+        std::cout << "WARNING - " << bad << " blocks failed verification" << std::endl;
+    } else {
+        std::cout << "All blocks verified" << std::endl;
+    }
+}
+
+// Read the root mode's files back and verify them against the checksums
+// the ranks sent. Unless the page cache is dropped first this mostly reads
+// from memory.
+static void readBack(const Workload& w, float* rBuf, int wsize,
+        const std::vector<uint32_t>& expected)
+{
+    const size_t perIntegration = wsize * w.integrity->blocks();
+    LatencyHistogram readHist("Read-back", w.intTime);
+    LatencyHistogram verifyHist("Read-back verify", w.intTime);
+    casa::Timer timer;
+    unsigned long bad = 0;
+    int missing = 0;
+    FILE *fptr = NULL;
+    for (int i = 0; i < w.integrations; ++i) {
+        if (i==0 || i%w.intPerFile == 0) {
+            if (fptr != NULL) {
+                fclose(fptr);
+            }
+            std::ostringstream oss;
+            oss << w.filename << "_" << i << ".dat";
+            fptr = fopen(oss.str().c_str(),"r");
+        }
+        timer.mark();
+        if (fptr == NULL || fread(rBuf, w.recvBufferSize, 1, fptr) != 1) {
+            ++missing;
+            continue;
+        }
+        readHist.record(timer.real());
+        timer.mark();
+        bad += w.integrity->verify((const char *) rBuf, wsize, &expected[i * perIntegration]);
+        verifyHist.record(timer.real());
+    }
+    if (fptr != NULL) {
+        fclose(fptr);
+    }
+    readHist.report(std::cout);
+    verifyHist.report(std::cout);
+    if (bad > 0 || missing > 0) {
+        std::cout << "WARNING - read-back found " << bad << " bad blocks and "
+            << missing << " missing integrations" << std::endl;
+    } else {
+        std::cout << "All blocks verified on read-back" << std::endl;
+    }
+}
+
+// Orders slice indices by the rank they came from
+struct SliceOrder {
+    explicit SliceOrder(const std::vector<int>& ranks) : itsRanks(ranks) {}
+    bool operator()(size_t a, size_t b) const { return itsRanks[a] < itsRanks[b]; }
+    const std::vector<int>& itsRanks;
+};
+
+// Gather to rank 0, which writes the whole integration. Returns the time
+// spent gathering and writing, excluding the wait for the next integration.
+static double runRoot(const Workload& w, float* sBuf, float* rBuf, int* rcounts,
+        int* displs, int rank)
+{
+    FILE *fptr=NULL;
+    casa::Timer timer;
+    casa::Timer total;
+    double busy = 0.0;
+    LatencyHistogram gatherHist("Gather", w.intTime);
+    LatencyHistogram writeHist("Write", w.intTime);
+    LatencyHistogram totalHist("Total", w.intTime);
+
+    // With integrity checking the checksums of every rank's blocks follow
+    // each integration to rank 0, which keeps them for the read-back
+    Integrity* check = w.integrity;
+    int wsize;
+    MPI_Comm_size(MPI_COMM_WORLD, &wsize);
+    const size_t blocks = (check != NULL) ? check->blocks() : 0;
+    const size_t perIntegration = wsize * blocks;
+    std::vector<uint32_t> expected((rank == 0) ? w.integrations * perIntegration : 0);
+    unsigned long bad = 0;
+    LatencyHistogram verifyHist("Verify", w.intTime);
+
+    total.mark();
+    Pacer pacer(w.intTime);
+
+    for (int i = 0; i < w.integrations; ++i) {
+        pacer.start();
+
+        if (i==0 || i%w.intPerFile == 0) {
+            if (fptr != NULL) {
+                fclose(fptr);
+            }
+            std::ostringstream oss;
+            oss << w.filename << "_" << i << ".dat";
+            fptr = fopen(oss.str().c_str(),"w");
+            assert(fptr);
+            setvbuf(fptr,NULL,w.recvBufferSize,_IOFBF);
+
+        }
+        doWorkWorker(sBuf, w, rank, i);
+        timer.mark();
+        MPI_Gatherv((void *) sBuf,w.nElements,MPI_FLOAT,(void *) rBuf,rcounts,displs,MPI_FLOAT,0,MPI_COMM_WORLD);
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (check != NULL) {
+            MPI_Gather(const_cast<uint32_t*>(check->sums()), blocks, MPI_UNSIGNED,
+                    rank == 0 ? &expected[i * perIntegration] : NULL, blocks, MPI_UNSIGNED,
+                    0, MPI_COMM_WORLD);
+        }
+
+        // Report progress
+        if (rank == 0) {
+            const float realtime = timer.real();
+            const float perf = static_cast<float>(w.intTime) / realtime;
+            if (w.verbose) {
+                if (perf < 1) {
+                    std::cout << "WARNING ";
+                }
+                std::cout << "Received integration " << i <<
+                " in " << realtime << " seconds"
+                << " (" << perf << "x requirement)" << std::endl;
+                std::cout << "Doing some work" << std::endl;
+            }
+            float verifyTime = 0.0;
+            if (check != NULL) {
+                casa::Timer verifyTimer;
+                verifyTimer.mark();
+                bad += check->verify((const char *) rBuf, wsize, &expected[i * perIntegration]);
+                verifyTime = verifyTimer.real();
+                verifyHist.record(verifyTime);
+            }
+            float workTime;
+            doWorkRoot(rBuf,w.recvBufferSize,&workTime,fptr);
+            if (w.verbose) {
+                std::cout << "Wrote integration " << i <<  " in "
+                << workTime << " seconds" << std::endl;
+            }
+            float combinedTime = workTime + realtime + verifyTime;
+            busy += combinedTime;
+            gatherHist.record(realtime);
+            writeHist.record(workTime);
+            totalHist.record(combinedTime);
+            if (combinedTime >= w.intTime && w.verbose) {
+                std::cout << "WARNING combined time greater than integration time" << std::endl;
+            }
+        }
+
+        // Every rank waits for the correlator's next integration
+        pacer.wait();
+    }
+
+    // Report totals
+    if (rank == 0) {
+        const float realtime = total.real();
+        const float perf = static_cast<float>(w.intTime * w.integrations) / realtime;
+        std::cout << "Received " << w.integrations << " integrations "
+            " in " << realtime << " seconds"
+            << " (" << perf << "x requirement)" << std::endl;
+        gatherHist.report(std::cout);
+        writeHist.report(std::cout);
+        totalHist.report(std::cout);
+    }
+    reportPacing(pacer, rank);
+    if (fptr != NULL) {
+        fclose(fptr);
+    }
+    if (check != NULL) {
+        reportIntegrity(w, verifyHist, bad, rank, wsize);
+        if (w.readback && rank == 0) {
+            readBack(w, rBuf, wsize, expected);
+        }
+    }
+
+    return busy;
+}
+
+// Every rank writes its own slice to its own file, with no gather
+static double runFilePerProcess(const Workload& w, float* sBuf, int rank)
+{
+    FILE *fptr=NULL;
+    casa::Timer timer;
+    double busy = 0.0;
+    LatencyHistogram writeHist("Write", w.intTime);
+    LatencyHistogram totalHist("Total", w.intTime);
+    Pacer pacer(w.intTime);
+
+    for (int i = 0; i < w.integrations; ++i) {
+        pacer.start();
+
+        if (i==0 || i%w.intPerFile == 0) {
+            if (fptr != NULL) {
+                fclose(fptr);
+            }
+            std::ostringstream oss;
+            oss << w.filename << "_" << i << "_" << rank << ".dat";
+            fptr = fopen(oss.str().c_str(),"w");
+            assert(fptr);
+            setvbuf(fptr,NULL,w.sendBufferSize,_IOFBF);
+        }
+
+        doWorkWorker(sBuf, w, rank, i);
+        timer.mark();
+        float workTime;
+        doWorkRoot(sBuf,w.sendBufferSize,&workTime,fptr);
+        const double maxWorkTime = maxOverRanks(workTime);
+        MPI_Barrier(MPI_COMM_WORLD);
+        const double realtime = maxOverRanks(timer.real());
+        busy += realtime;
+
+        if (rank == 0) {
+            writeHist.record(maxWorkTime);
+            totalHist.record(realtime);
+            const float perf = static_cast<float>(w.intTime) / realtime;
+            if (w.verbose) {
+                if (perf < 1) {
+                    std::cout << "WARNING ";
+                }
+                std::cout << "Wrote integration " << i << " (file per process) in "
+                    << realtime << " seconds (" << perf << "x requirement)" << std::endl;
+            }
+        }
+
+        // Every rank waits for the correlator's next integration
+        pacer.wait();
+    }
+
+    if (rank == 0) {
+        writeHist.report(std::cout);
+        totalHist.report(std::cout);
+    }
+    if (fptr != NULL) {
+        fclose(fptr);
+    }
+    reportPacing(pacer, rank);
+    return busy;
+}
+
+// All ranks write their slice into one shared file per intPerFile
+// integrations with MPI_File_write_at_all, so the MPI-IO layer can
+// aggregate the writes (collective buffering) across ranks
+static double runCollective(const Workload& w, float* sBuf, int rank, MPI_Info info)
+{
+    MPI_File fh = MPI_FILE_NULL;
+    casa::Timer timer;
+    double busy = 0.0;
+    LatencyHistogram totalHist("Total", w.intTime);
+    Pacer pacer(w.intTime);
+
+    for (int i = 0; i < w.integrations; ++i) {
+        pacer.start();
+
+        if (i==0 || i%w.intPerFile == 0) {
+            if (fh != MPI_FILE_NULL) {
+                MPI_File_close(&fh);
+            }
+            std::ostringstream oss;
+            oss << w.filename << "_" << i << "_collective.dat";
+
+            // Start from an empty file, MPI_MODE_CREATE does not truncate
+            if (rank == 0) {
+                MPI_File_delete(const_cast<char*>(oss.str().c_str()), MPI_INFO_NULL);
+            }
+            MPI_Barrier(MPI_COMM_WORLD);
+            const int rtn = MPI_File_open(MPI_COMM_WORLD, const_cast<char*>(oss.str().c_str()),
+                    MPI_MODE_CREATE | MPI_MODE_WRONLY, info, &fh);
+            if (rtn != MPI_SUCCESS) {
+                std::cout << "WARNING - failed to open " << oss.str() << std::endl;
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+        }
+
+        // The integrations in a file are laid out one after the other,
+        // each as the rank slices in rank order
+        const MPI_Offset offset = static_cast<MPI_Offset>(i % w.intPerFile) * w.recvBufferSize
+            + static_cast<MPI_Offset>(rank) * w.sendBufferSize;
+
+        doWorkWorker(sBuf, w, rank, i);
+        timer.mark();
+        MPI_Status status;
+        if (MPI_File_write_at_all(fh, offset, sBuf, w.nElements, MPI_FLOAT, &status)
+                != MPI_SUCCESS) {
+            std::cout << "WARNING - failed write" << std::endl;
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+        const double realtime = maxOverRanks(timer.real());
+        busy += realtime;
+
+        if (rank == 0) {
+            totalHist.record(realtime);
+            const float perf = static_cast<float>(w.intTime) / realtime;
+            if (w.verbose) {
+                if (perf < 1) {
+                    std::cout << "WARNING ";
+                }
+                std::cout << "Wrote integration " << i << " (collective) in "
+                    << realtime << " seconds (" << perf << "x requirement)" << std::endl;
+            }
+        }
+
+        // Every rank waits for the correlator's next integration
+        pacer.wait();
+    }
+
+    if (rank == 0) {
+        totalHist.report(std::cout);
+    }
+    if (fh != MPI_FILE_NULL) {
+        MPI_File_close(&fh);
+    }
+    reportPacing(pacer, rank);
+    return busy;
+}
+
+// Test the outstanding gathers, noting when each is first seen complete.
+// Also drives progress of the gathers while a rank is writing or pacing.
+static void pollGathers(std::vector<MPI_Request>& req, std::vector<double>& done)
+{
+    for (size_t s = 0; s < req.size(); ++s) {
+        if (req[s] != MPI_REQUEST_NULL) {
+            int flag = 0;
+            MPI_Test(&req[s], &flag, MPI_STATUS_IGNORE);
+            if (flag) {
+                done[s] = MPI_Wtime();
+            }
+        }
+    }
+}
+
+// As doWorkRoot, polling the gathers in flight between blocks
+static double writePolling(const char* buffer, size_t buffsize, FILE* fptr,
+        std::vector<MPI_Request>& req, std::vector<double>& done)
+{
+    const double start = MPI_Wtime();
+    size_t written = 0;
+    while (written < buffsize) {
+        const size_t block = std::min(static_cast<size_t>(BLOCKSIZE), buffsize - written);
+        if (fwrite(buffer + written, block, 1, fptr) != 1) {
+            std::cout << "WARNING - failed write" << std::endl;
+            break;
+        }
+        written += block;
+        pollGathers(req, done);
+    }
+    return MPI_Wtime() - start;
+}
+
+// Pipelined gather: each integration is gathered with MPI_Igatherv into a
+// ring of depth receive buffers while rank 0 writes the one depth - 1
+// integrations earlier. There is no barrier per integration; every rank
+// paces itself to the integration time, as the correlator would, and keeps
+// testing its gathers meanwhile so they progress. Returns the time rank 0
+// spent waiting for gathers and writing.
+static double runPipelined(const Workload& w, int depth, int* rcounts, int* displs, int rank)
+{
+    const int lag = depth - 1;
+    std::vector<float*> sRing(depth, static_cast<float*>(NULL));
+    std::vector<float*> rRing(depth, static_cast<float*>(NULL));
+    std::vector<MPI_Request> req(depth, MPI_REQUEST_NULL);
+    std::vector<double> posted(depth, 0.0);
+    std::vector<double> done(depth, 0.0);
+    for (int s = 0; s < depth; ++s) {
+        sRing[s] = (float *) malloc(w.sendBufferSize);
+        if (rank == 0) {
+            rRing[s] = (float *) malloc(w.recvBufferSize);
+        }
+    }
+
+    FILE *fptr=NULL;
+    double busy = 0.0;
+    double inFlight = 0.0;
+    double exposed = 0.0;
+    LatencyHistogram gatherHist("Gather", w.intTime);
+    LatencyHistogram waitHist("Gather wait", w.intTime);
+    LatencyHistogram writeHist("Write", w.intTime);
+    const double start = MPI_Wtime();
+    Pacer pacer(w.intTime);
+
+    for (int i = 0; i < w.integrations + lag; ++i) {
+        if (i < w.integrations) {
+            const int slot = i % depth;
+            pacer.start();
+
+            // The send buffer of a slot is free once its last gather is done
+            if (req[slot] != MPI_REQUEST_NULL) {
+                MPI_Wait(&req[slot], MPI_STATUS_IGNORE);
+            }
+            doWorkWorker(sRing[slot], w, rank, i);
+            MPI_Igatherv((void *) sRing[slot], w.nElements, MPI_FLOAT, (void *) rRing[slot],
+                    rcounts, displs, MPI_FLOAT, 0, MPI_COMM_WORLD, &req[slot]);
+            posted[slot] = MPI_Wtime();
+            done[slot] = 0.0;
+        }
+
+        if (rank == 0 && i >= lag) {
+            const int j = i - lag;
+            const int prev = j % depth;
+            if (j == 0 || j%w.intPerFile == 0) {
+                if (fptr != NULL) {
+                    fclose(fptr);
+                }
+                std::ostringstream oss;
+                oss << w.filename << "_" << j << "_pipelined.dat";
+                fptr = fopen(oss.str().c_str(),"w");
+                assert(fptr);
+                setvbuf(fptr,NULL,w.recvBufferSize,_IOFBF);
+            }
+
+            // Only the part of the gather still outstanding is exposed
+            const double waitStart = MPI_Wtime();
+            if (req[prev] != MPI_REQUEST_NULL) {
+                MPI_Wait(&req[prev], MPI_STATUS_IGNORE);
+                done[prev] = MPI_Wtime();
+            }
+            const double waitTime = MPI_Wtime() - waitStart;
+            const double gatherTime = done[prev] - posted[prev];
+            const double writeTime = writePolling((const char *) rRing[prev],
+                    w.recvBufferSize, fptr, req, done);
+            busy += waitTime + writeTime;
+            exposed += waitTime;
+            inFlight += gatherTime;
+            gatherHist.record(gatherTime);
+            waitHist.record(waitTime);
+            writeHist.record(writeTime);
+            if (w.verbose) {
+                std::cout << "Wrote integration " << j << " in " << writeTime
+                    << " seconds, gathered in " << gatherTime << " seconds of which "
+                    << waitTime << " exposed" << std::endl;
+            }
+        }
+
+        // Pace to the next integration, the remaining writes are drained
+        // as fast as possible
+        if (i < w.integrations - 1) {
+            const double overrun = Pacer::now() - pacer.next();
+            if (rank == 0 && overrun > 0.0 && w.verbose) {
+                std::cout << "WARNING integration " << i << " overran by "
+                    << overrun << " seconds" << std::endl;
+            }
+            while (!pacer.wait(0.001)) {
+                pollGathers(req, done);
+            }
+        }
+    }
+
+    // Non-root ranks may still have their last sends in flight
+    for (int s = 0; s < depth; ++s) {
+        if (req[s] != MPI_REQUEST_NULL) {
+            MPI_Wait(&req[s], MPI_STATUS_IGNORE);
+        }
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        const float realtime = MPI_Wtime() - start;
+        const float perf = static_cast<float>(w.intTime * w.integrations) / realtime;
+        std::cout << "Received " << w.integrations << " integrations "
+            " in " << realtime << " seconds"
+            << " (" << perf << "x requirement)" << std::endl;
+        gatherHist.report(std::cout);
+        waitHist.report(std::cout);
+        writeHist.report(std::cout);
+        if (inFlight > 0.0) {
+            std::cout << "Gather time hidden behind I/O: "
+                << 100.0 * (1.0 - exposed / inFlight) << "% ("
+                << exposed << " of " << inFlight << " seconds exposed)" << std::endl;
+        }
+    }
+    reportPacing(pacer, rank);
+
+    if (fptr != NULL) {
+        fclose(fptr);
+    }
+    for (int s = 0; s < depth; ++s) {
+        free(sRing[s]);
+        free(rRing[s]);
+    }
+    return busy;
 }
 
+// Segmented gather: each integration is gathered nChan channels at a time
+// and every segment is handed to a writer thread as soon as it arrives, so
+// receiving a segment overlaps writing the one before. Rank 0 needs only
+// nBuffers buffers of one segment each rather than a whole integration.
+// Returns the time spent gathering and writing.
+static double runSegmented(const Workload& w, int nChan, int nBuffers, float* sBuf, int rank,
+        int wsize)
+{
+    const size_t perChannel = w.nElements / w.channels;
+    const int nSegments = (w.channels + nChan - 1) / nChan;
+    SegmentWriter* writer = NULL;
+    if (rank == 0) {
+        writer = new SegmentWriter(static_cast<size_t>(wsize) * nChan * perChannel * sizeof(float),
+                nBuffers);
+        std::cout << "Gathering " << nSegments << " segments of " << nChan
+            << " channels per integration into " << writer->depth() << " buffers of "
+            << writer->bufferBytes() / (1024 * 1024) << " MB" << std::endl;
+    }
+
+    int fd = -1;
+    casa::Timer timer;
+    casa::Timer total;
+    double busy = 0.0;
+    double drain = 0.0;
+    LatencyHistogram gatherHist("Gather", w.intTime);
+    LatencyHistogram drainHist("Write drain", w.intTime);
+    LatencyHistogram totalHist("Total", w.intTime);
+    total.mark();
+    Pacer pacer(w.intTime);
+
+    for (int i = 0; i < w.integrations; ++i) {
+        if (rank == 0 && (i==0 || i%w.intPerFile == 0)) {
+            if (fd >= 0) {
+                writer->flush();
+                close(fd);
+            }
+            std::ostringstream oss;
+            oss << w.filename << "_" << i << "_segmented.dat";
+            fd = open(oss.str().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            assert(fd >= 0);
+        }
+
+        pacer.start();
+        doWorkWorker(sBuf, w, rank, i);
+        timer.mark();
+        const off_t base = static_cast<off_t>(i % w.intPerFile) * w.recvBufferSize;
+        for (int k = 0; k < nSegments; ++k) {
+            const size_t first = static_cast<size_t>(k) * nChan;
+            const size_t count = std::min(static_cast<size_t>(nChan), w.channels - first)
+                * perChannel;
+            float* rBuf = (rank == 0) ? writer->acquire() : NULL;
+            MPI_Gather((void *) (sBuf + first * perChannel), count, MPI_FLOAT,
+                    (void *) rBuf, count, MPI_FLOAT, 0, MPI_COMM_WORLD);
+            if (rank == 0) {
+                Segment segment;
+                segment.data = rBuf;
+                segment.fd = fd;
+                segment.offset = base + first * perChannel * sizeof(float);
+                segment.stride = w.sendBufferSize;
+                segment.pieceBytes = count * sizeof(float);
+                segment.nPieces = wsize;
+                writer->submit(segment);
+            }
+        }
+
+        if (rank == 0) {
+            const float gatherTime = timer.real();
+            casa::Timer drainTimer;
+            drainTimer.mark();
+            writer->flush();
+            const float drainTime = drainTimer.real();
+            const float realtime = timer.real();
+            const float perf = static_cast<float>(w.intTime) / realtime;
+            busy += realtime;
+            drain += drainTime;
+            gatherHist.record(gatherTime);
+            drainHist.record(drainTime);
+            totalHist.record(realtime);
+            if (w.verbose) {
+                if (perf < 1) {
+                    std::cout << "WARNING ";
+                }
+                std::cout << "Wrote integration " << i << " (segmented) in "
+                    << realtime << " seconds (" << perf << "x requirement), "
+                    << drainTime << " of them after the last segment arrived" << std::endl;
+            }
+        }
+
+        // Every rank waits for the correlator's next integration
+        pacer.wait();
+    }
+
+    if (rank == 0) {
+        const float realtime = total.real();
+        const float perf = static_cast<float>(w.intTime * w.integrations) / realtime;
+        std::cout << "Received " << w.integrations << " integrations "
+            " in " << realtime << " seconds"
+            << " (" << perf << "x requirement)" << std::endl;
+        gatherHist.report(std::cout);
+        drainHist.report(std::cout);
+        totalHist.report(std::cout);
+        const double writeTime = writer->writeTime();
+        if (writeTime > 0.0) {
+            std::cout << "Write time overlapped with receiving: "
+                << 100.0 * (1.0 - drain / writeTime) << "% ("
+                << writer->stalls() << " waits for a free buffer, "
+                << writer->stallTime() << " seconds)" << std::endl;
+        }
+        delete writer;
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    reportPacing(pacer, rank);
+    return busy;
+}
+
+// Gather to rank 0, which writes each integration through a pool of
+// striped streams; the writer is only needed on rank 0. With O_DIRECT each
+// integration starts on an aligned offset, so may be followed by padding.
+static double runStriped(const Workload& w, StripedWriter* writer, float* sBuf,
+        int* rcounts, int* displs, int rank)
+{
+    const size_t align = StripedWriter::alignment;
+    const size_t stride = (writer != NULL && writer->direct()) ?
+        (w.recvBufferSize + align - 1) / align * align : w.recvBufferSize;
+    char* rBuf = NULL;
+    if (rank == 0) {
+        void* p = NULL;
+        if (posix_memalign(&p, align, stride) != 0) {
+            std::cout << "WARNING - failed to allocate the receive buffer" << std::endl;
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        rBuf = (char *) p;
+        memset(rBuf + w.recvBufferSize, 0, stride - w.recvBufferSize);
+        std::cout << "Striping over " << writer->streams() << " streams of "
+            << writer->blockSize() << " byte blocks"
+            << (writer->separate() ? ", a file each" : ", one shared file")
+            << (writer->direct() ? ", O_DIRECT" : "") << std::endl;
+    }
+
+    casa::Timer timer;
+    casa::Timer writeTimer;
+    casa::Timer total;
+    double busy = 0.0;
+    double writing = 0.0;
+    LatencyHistogram gatherHist("Gather", w.intTime);
+    LatencyHistogram writeHist("Write", w.intTime);
+    LatencyHistogram totalHist("Total", w.intTime);
+    total.mark();
+    Pacer pacer(w.intTime);
+
+    for (int i = 0; i < w.integrations; ++i) {
+        if (rank == 0 && (i==0 || i%w.intPerFile == 0)) {
+            std::ostringstream oss;
+            oss << w.filename << "_" << i << "_striped";
+            writer->open(oss.str());
+        }
+
+        pacer.start();
+        doWorkWorker(sBuf, w, rank, i);
+        timer.mark();
+        MPI_Gatherv((void *) sBuf,w.nElements,MPI_FLOAT,(void *) rBuf,rcounts,displs,MPI_FLOAT,0,MPI_COMM_WORLD);
+
+        if (rank == 0) {
+            const float gatherTime = timer.real();
+            writeTimer.mark();
+            writer->write(rBuf, w.recvBufferSize, static_cast<off_t>(i % w.intPerFile) * stride);
+            const float writeTime = writeTimer.real();
+            const float realtime = timer.real();
+            const float perf = static_cast<float>(w.intTime) / realtime;
+            busy += realtime;
+            writing += writeTime;
+            gatherHist.record(gatherTime);
+            writeHist.record(writeTime);
+            totalHist.record(realtime);
+            if (w.verbose) {
+                if (perf < 1) {
+                    std::cout << "WARNING ";
+                }
+                std::cout << "Wrote integration " << i << " (striped) in "
+                    << realtime << " seconds (" << perf << "x requirement), "
+                    << writeTime << " of them writing" << std::endl;
+            }
+        }
+
+        // Every rank waits for the correlator's next integration
+        pacer.wait();
+    }
+
+    if (rank == 0) {
+        writer->close();
+        const float realtime = total.real();
+        const float perf = static_cast<float>(w.intTime * w.integrations) / realtime;
+        std::cout << "Received " << w.integrations << " integrations "
+            " in " << realtime << " seconds"
+            << " (" << perf << "x requirement)" << std::endl;
+        gatherHist.report(std::cout);
+        writeHist.report(std::cout);
+        totalHist.report(std::cout);
+        double bytes = 0.0;
+        for (int s = 0; s < writer->streams(); ++s) {
+            bytes += writer->bytes(s);
+            if (writer->seconds(s) > 0.0) {
+                std::cout << "Stream " << s << " bandwidth: "
+                    << writer->bytes(s) / (1024.0 * 1024.0) / writer->seconds(s) << " MB/s" << std::endl;
+            }
+        }
+        if (writing > 0.0) {
+            std::cout << "Striped write bandwidth: "
+                << bytes / (1024.0 * 1024.0) / writing << " MB/s" << std::endl;
+        }
+        free(rBuf);
+    }
+    reportPacing(pacer, rank);
+    return busy;
+}
+
+// Real-time model: rank 0 gathers each integration on schedule into a
+// bounded queue drained by a writer thread, and the queue's policy decides
+// what happens when the writer falls behind. The correlator only stalls
+// if the policy is block. Returns the time the writer would take for every
+// integration, at its mean write time, as dropped ones were not written.
+static double runQueued(const Workload& w, IngestQueue* queue, float* sBuf,
+        int* rcounts, int* displs, int rank)
+{
+    if (rank == 0) {
+        std::cout << "Queueing up to " << queue->depth() << " integrations, "
+            << IngestQueue::name(queue->policy()) << " when full" << std::endl;
+    }
+
+    casa::Timer timer;
+    casa::Timer total;
+    double busy = 0.0;
+    LatencyHistogram gatherHist("Gather", w.intTime);
+    total.mark();
+    Pacer pacer(w.intTime);
+
+    for (int i = 0; i < w.integrations; ++i) {
+        pacer.start();
+        doWorkWorker(sBuf, w, rank, i);
+        timer.mark();
+        float* rBuf = (rank == 0) ? queue->acquire() : NULL;
+        MPI_Gatherv((void *) sBuf,w.nElements,MPI_FLOAT,(void *) rBuf,rcounts,displs,MPI_FLOAT,0,MPI_COMM_WORLD);
+
+        if (rank == 0) {
+            queue->submit(rBuf, i);
+            const float realtime = timer.real();
+            const float perf = static_cast<float>(w.intTime) / realtime;
+            gatherHist.record(realtime);
+            if (w.verbose) {
+                if (perf < 1) {
+                    std::cout << "WARNING ";
+                }
+                std::cout << "Received integration " << i << " (queued) in "
+                    << realtime << " seconds (" << perf << "x requirement)" << std::endl;
+            }
+        }
+
+        // Every rank waits for the correlator's next integration
+        pacer.wait();
+    }
+
+    if (rank == 0) {
+        casa::Timer drain;
+        drain.mark();
+        queue->flush();
+        const float drainTime = drain.real();
+        const float realtime = total.real();
+        const float perf = static_cast<float>(w.intTime * w.integrations) / realtime;
+        std::cout << "Received " << w.integrations << " integrations "
+            " in " << realtime << " seconds"
+            << " (" << perf << "x requirement)" << std::endl;
+        gatherHist.report(std::cout);
+        queue->writeLatency().report(std::cout);
+        std::cout << "Queued " << queue->queued() << ", written " << queue->written()
+            << ", dropped " << queue->dropped() << ", spilled " << queue->spilled()
+            << " (" << queue->spillTime() << " seconds spilling)" << std::endl;
+        std::cout << "Correlator stalls: " << queue->stalls() << " ("
+            << queue->stallTime() << " seconds), queue high water "
+            << queue->highWater() << " of " << queue->depth()
+            << ", " << drainTime << " seconds to drain at the end" << std::endl;
+        busy = queue->writeLatency().mean() * w.integrations;
+    }
+    reportPacing(pacer, rank);
+    return busy;
+}
+
+// Shared-memory transport: the ranks on rank 0's node copy their slice
+// straight into a POSIX shared-memory ring that rank 0 writes from, so only
+// ranks on other nodes gather to rank 0 through MPI. Returns the time spent
+// gathering and writing.
+static double runShm(const Workload& w, int depth, float* sBuf, int* rcounts, int* displs,
+        int rank, int wsize)
+{
+    // Which ranks share rank 0's node
+    MPI_Comm node;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node);
+    int nodeSize;
+    MPI_Comm_size(node, &nodeSize);
+    int local = (rank == 0) ? 1 : 0;
+    MPI_Allreduce(MPI_IN_PLACE, &local, 1, MPI_INT, MPI_MAX, node);
+    const bool producer = local && rank != 0;
+
+    // Rank 0 and the ranks on other nodes still gather through MPI
+    MPI_Comm remote;
+    MPI_Comm_split(MPI_COMM_WORLD, producer ? MPI_UNDEFINED : 0, rank, &remote);
+    std::vector<int> remoteCounts;
+    std::vector<int> remoteDispls;
+    if (rank == 0) {
+        int remoteSize;
+        MPI_Comm_size(remote, &remoteSize);
+        MPI_Group worldGroup, remoteGroup;
+        MPI_Comm_group(MPI_COMM_WORLD, &worldGroup);
+        MPI_Comm_group(remote, &remoteGroup);
+        std::vector<int> ranks(remoteSize);
+        std::vector<int> worldRanks(remoteSize);
+        for (int r = 0; r < remoteSize; ++r) {
+            ranks[r] = r;
+        }
+        MPI_Group_translate_ranks(remoteGroup, remoteSize, &ranks[0], worldGroup, &worldRanks[0]);
+        for (int r = 0; r < remoteSize; ++r) {
+            remoteCounts.push_back(rcounts[worldRanks[r]]);
+            remoteDispls.push_back(displs[worldRanks[r]]);
+        }
+        MPI_Group_free(&worldGroup);
+        MPI_Group_free(&remoteGroup);
+        std::cout << "Ranks on the writer's node: " << nodeSize << " (" << nodeSize - 1
+            << " through shared memory), " << wsize - nodeSize << " through MPI" << std::endl;
+    }
+
+    // Rank 0 creates the ring, named after its process, and removes the
+    // name once the other ranks on the node have attached
+    ShmRing* ring = NULL;
+    if (local) {
+        int pid = getpid();
+        MPI_Bcast(&pid, 1, MPI_INT, 0, node);
+        std::ostringstream name;
+        name << "/mpiperf_" << pid;
+        if (rank == 0) {
+            ring = new ShmRing(name.str(), w.recvBufferSize, depth, nodeSize - 1, true);
+        }
+        MPI_Barrier(node);
+        if (producer) {
+            ring = new ShmRing(name.str(), w.recvBufferSize, depth, nodeSize - 1, false);
+        }
+        MPI_Barrier(node);
+        if (rank == 0) {
+            ring->unlink();
+        }
+    }
+    int good = (ring == NULL || ring->ok()) ? 1 : 0;
+    MPI_Allreduce(MPI_IN_PLACE, &good, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (!good) {
+        if (rank == 0) {
+            std::cout << "WARNING - no shared-memory ring, skipping the shm mode" << std::endl;
+        }
+        delete ring;
+        if (remote != MPI_COMM_NULL) {
+            MPI_Comm_free(&remote);
+        }
+        MPI_Comm_free(&node);
+        return 0.0;
+    }
+
+    FILE *fptr=NULL;
+    casa::Timer timer;
+    casa::Timer total;
+    double busy = 0.0;
+    LatencyHistogram gatherHist("Gather", w.intTime);
+    LatencyHistogram writeHist("Write", w.intTime);
+    LatencyHistogram totalHist("Total", w.intTime);
+    LatencyHistogram depositHist("Deposit", w.intTime);
+    total.mark();
+    Pacer pacer(w.intTime);
+
+    for (int i = 0; i < w.integrations; ++i) {
+        if (rank == 0 && (i==0 || i%w.intPerFile == 0)) {
+            if (fptr != NULL) {
+                fclose(fptr);
+            }
+            std::ostringstream oss;
+            oss << w.filename << "_" << i << "_shm.dat";
+            fptr = fopen(oss.str().c_str(),"w");
+            assert(fptr);
+            setvbuf(fptr,NULL,w.recvBufferSize,_IOFBF);
+        }
+
+        pacer.start();
+        doWorkWorker(sBuf, w, rank, i);
+        timer.mark();
+        if (producer) {
+            char* slot = ring->claim(i);
+            memcpy(slot + static_cast<size_t>(displs[rank]) * sizeof(float), sBuf, w.sendBufferSize);
+            ring->deposit(i);
+            depositHist.record(timer.real());
+        } else {
+            char* slot = (rank == 0) ? ring->claim(i) : NULL;
+            MPI_Gatherv((void *) sBuf,w.nElements,MPI_FLOAT,(void *) slot,
+                    rank == 0 ? &remoteCounts[0] : NULL, rank == 0 ? &remoteDispls[0] : NULL,
+                    MPI_FLOAT,0,remote);
+            if (rank == 0) {
+                ring->collect(i);
+                const float gatherTime = timer.real();
+                float workTime;
+                doWorkRoot(slot,w.recvBufferSize,&workTime,fptr);
+                ring->release(i);
+                const float realtime = timer.real();
+                const float perf = static_cast<float>(w.intTime) / realtime;
+                busy += realtime;
+                gatherHist.record(gatherTime);
+                writeHist.record(workTime);
+                totalHist.record(realtime);
+                if (w.verbose) {
+                    if (perf < 1) {
+                        std::cout << "WARNING ";
+                    }
+                    std::cout << "Wrote integration " << i << " (shm) in "
+                        << realtime << " seconds (" << perf << "x requirement), "
+                        << workTime << " of them writing" << std::endl;
+                }
+            }
+        }
+
+        // Every rank waits for the correlator's next integration
+        pacer.wait();
+    }
+
+    // How long each producer took to hand over its slice, including any
+    // wait for the writer to free the slot
+    double mine[4] = { depositHist.mean(), depositHist.percentile(99.0), depositHist.max(),
+        static_cast<double>(ring != NULL ? ring->waits() : 0) };
+    std::vector<double> all(4 * wsize);
+    MPI_Gather(mine, 4, MPI_DOUBLE, &all[0], 4, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        const float realtime = total.real();
+        const float perf = static_cast<float>(w.intTime * w.integrations) / realtime;
+        std::cout << "Received " << w.integrations << " integrations "
+            " in " << realtime << " seconds"
+            << " (" << perf << "x requirement)" << std::endl;
+        gatherHist.report(std::cout);
+        writeHist.report(std::cout);
+        totalHist.report(std::cout);
+        std::cout << "Writer waits on the ring: " << ring->waits() << std::endl;
+        for (int r = 1; r < wsize; ++r) {
+            const double* v = &all[4 * r];
+            if (v[0] > 0.0) {
+                std::cout << "Rank " << r << " deposit (s): mean " << v[0] << ", p99 " << v[1]
+                    << ", max " << v[2] << ", " << v[3] << " waits for a free slot" << std::endl;
+            }
+        }
+        if (fptr != NULL) {
+            fclose(fptr);
+        }
+    }
+    reportPacing(pacer, rank);
+    delete ring;
+    if (remote != MPI_COMM_NULL) {
+        MPI_Comm_free(&remote);
+    }
+    MPI_Comm_free(&node);
+    return busy;
+}
+
+// Hierarchical gather: the ranks on each node gather to the node's leader,
+// and the leaders gather to the writers, each of which writes its group of
+// nodes to its own file (with one writer, the root mode's file). With
+// compare set, an unpaced pass after the run times hierarchical and flat
+// gathers of the same data side by side. Returns the slowest writer's time
+// spent gathering and writing.
+static double runHierarchical(const Workload& w, int writers, bool compare, float* sBuf,
+        float* rBuf, int* rcounts, int* displs, int rank)
+{
+    HierarchicalGather gather(MPI_COMM_WORLD, w.nElements, writers);
+
+    // Slices are written in rank order, whatever the placement of ranks
+    // on nodes
+    std::vector<size_t> order(gather.slices());
+    for (size_t k = 0; k < order.size(); ++k) {
+        order[k] = k;
+    }
+    std::sort(order.begin(), order.end(), SliceOrder(gather.ranks()));
+    bool inOrder = true;
+    for (size_t k = 0; k < order.size(); ++k) {
+        inOrder = inOrder && order[k] == k;
+    }
+    if (rank == 0) {
+        std::cout << "Gathering over " << gather.nodes() << " nodes (" << gather.nodeSize()
+            << " ranks on the first) to " << gather.writers() << " writers" << std::endl;
+    }
+
+    FILE *fptr=NULL;
+    casa::Timer timer;
+    casa::Timer flatTimer;
+    casa::Timer total;
+    double busy = 0.0;
+    LatencyHistogram nodeHist("Node gather", w.intTime);
+    LatencyHistogram interHist("Inter-node gather", w.intTime);
+    LatencyHistogram gatherHist("Gather", w.intTime);
+    LatencyHistogram writeHist("Write", w.intTime);
+    LatencyHistogram totalHist("Total", w.intTime);
+    LatencyHistogram hierHist("Unpaced hierarchical gather", w.intTime);
+    LatencyHistogram flatHist("Unpaced flat gather", w.intTime);
+    total.mark();
+    Pacer pacer(w.intTime);
+
+    for (int i = 0; i < w.integrations; ++i) {
+        if (gather.writer() && (i==0 || i%w.intPerFile == 0)) {
+            if (fptr != NULL) {
+                fclose(fptr);
+            }
+            std::ostringstream oss;
+            oss << w.filename << "_" << i << "_hier";
+            if (gather.writers() > 1) {
+                oss << "_" << gather.writerIndex();
+            }
+            oss << ".dat";
+            fptr = fopen(oss.str().c_str(),"w");
+            assert(fptr);
+            setvbuf(fptr,NULL,w.recvBufferSize,_IOFBF);
+        }
+
+        pacer.start();
+        doWorkWorker(sBuf, w, rank, i);
+
+        // Start together, as the flat gather in the comparison does, so
+        // rank skew is not counted as gather time
+        MPI_Barrier(MPI_COMM_WORLD);
+        timer.mark();
+        gather.gather(sBuf, rBuf);
+
+        if (gather.writer()) {
+            const float gatherTime = timer.real();
+            float workTime = 0.0;
+            if (inOrder) {
+                doWorkRoot(rBuf, gather.slices() * w.sendBufferSize, &workTime, fptr);
+            } else {
+                for (size_t k = 0; k < order.size(); ++k) {
+                    float sliceTime;
+                    doWorkRoot(rBuf + order[k] * w.nElements, w.sendBufferSize, &sliceTime, fptr);
+                    workTime += sliceTime;
+                }
+            }
+            const float realtime = timer.real();
+            busy += realtime;
+            if (rank == 0) {
+                const float perf = static_cast<float>(w.intTime) / realtime;
+                nodeHist.record(gather.nodeTime());
+                interHist.record(gather.interTime());
+                gatherHist.record(gatherTime);
+                writeHist.record(workTime);
+                totalHist.record(realtime);
+                if (w.verbose) {
+                    if (perf < 1) {
+                        std::cout << "WARNING ";
+                    }
+                    std::cout << "Wrote integration " << i << " (hierarchical) in "
+                        << realtime << " seconds (" << perf << "x requirement), "
+                        << gatherTime << " of them gathering" << std::endl;
+                }
+            }
+        }
+
+        // Every rank waits for the correlator's next integration
+        pacer.wait();
+    }
+    const float elapsed = total.real();
+
+    if (fptr != NULL) {
+        fclose(fptr);
+    }
+
+    // The comparison is a separate, unpaced pass, so it adds nothing to the
+    // paced run: each round times a hierarchical and a flat gather of the
+    // same data, both started from a barrier, and writes nothing
+    if (compare) {
+        for (int i = 0; i < w.integrations; ++i) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            flatTimer.mark();
+            gather.gather(sBuf, rBuf);
+            if (rank == 0) {
+                hierHist.record(flatTimer.real());
+            }
+            MPI_Barrier(MPI_COMM_WORLD);
+            flatTimer.mark();
+            MPI_Gatherv((void *) sBuf,w.nElements,MPI_FLOAT,(void *) rBuf,rcounts,displs,MPI_FLOAT,0,MPI_COMM_WORLD);
+            if (rank == 0) {
+                flatHist.record(flatTimer.real());
+            }
+        }
+    }
+    busy = maxOverRanks(busy);
+    if (rank == 0) {
+        const float perf = static_cast<float>(w.intTime * w.integrations) / elapsed;
+        std::cout << "Received " << w.integrations << " integrations "
+            " in " << elapsed << " seconds"
+            << " (" << perf << "x requirement)" << std::endl;
+        nodeHist.report(std::cout);
+        interHist.report(std::cout);
+        gatherHist.report(std::cout);
+        writeHist.report(std::cout);
+        totalHist.report(std::cout);
+        if (compare) {
+            hierHist.report(std::cout);
+            flatHist.report(std::cout);
+            if (hierHist.mean() > 0.0) {
+                std::cout << "Hierarchical gather speedup over flat: "
+                    << flatHist.mean() / hierHist.mean() << "x on " << gather.nodes()
+                    << " nodes" << std::endl;
+            }
+        }
+    }
+    reportPacing(pacer, rank);
+    return busy;
+}
 
 int main(int argc, char *argv[])
 {
-    // MPI init
-    MPI_Init(&argc, &argv);
+    // MPI init, the segmented mode's writer thread makes no MPI calls
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
     int rank,wsize;
 
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
@@ -116,12 +1331,6 @@ int main(int argc, char *argv[])
     // Replace in the filename the %w pattern with the rank number
     std::string filename = subset.getString("filename");
 
-    // create the output file
-    FILE *fptr=NULL;
-
-
-
-
     int intTime = subset.getInt32("integrationTime",5);
     int integrations = subset.getInt32("nIntegrations",1);
     int antennas = subset.getInt32("nAntenna",36);
@@ -156,9 +1365,86 @@ int main(int argc, char *argv[])
        rcounts[i] = nElements;
     }
 
-    casa::Timer timer;
-    casa::Timer total;
-    total.mark();
+    Workload work;
+    work.filename = filename;
+    work.intTime = intTime;
+    work.integrations = integrations;
+    work.intPerFile = intPerFile;
+    work.channels = channels;
+    work.nElements = nElements;
+    work.sendBufferSize = sendBufferSize;
+    work.recvBufferSize = recvBufferSize;
+
+    // Per-integration progress lines; the latency summaries at the end of
+    // each mode are always printed
+    work.verbose = subset.getBool("verbose", true);
+
+    // Synthetic payload and CRC32C checksums of each block of it, verified
+    // on rank 0 in the root mode and optionally when read back
+    Integrity* integrity = NULL;
+    if (subset.getBool("integrity", false)) {
+        integrity = new Integrity(sendBufferSize, subset.getInt32("integrity.blocksize", BLOCKSIZE),
+                intTime);
+    }
+    work.integrity = integrity;
+    work.readback = subset.getBool("integrity.readback", false);
+
+    // One of root (gather to rank 0, which writes), pipelined (non-blocking
+    // gather overlapping the writes), segmented (gather by channel block
+    // streamed to a writer thread), striped (gather to rank 0, which writes
+    // through several streams), queued (bounded queue with a drop policy),
+    // shm (ranks on rank 0's node hand over through shared memory),
+    // hierarchical (node then inter-node gather to one or more writers),
+    // fileperprocess, collective (MPI-IO shared file), or all to compare
+    // them in turn
+    const std::string writemode = subset.getString("writemode", "root");
+    std::vector<std::string> modes;
+    if (writemode == "all") {
+        modes.push_back("root");
+        modes.push_back("pipelined");
+        modes.push_back("segmented");
+        modes.push_back("striped");
+        modes.push_back("queued");
+        modes.push_back("shm");
+        modes.push_back("hierarchical");
+        modes.push_back("fileperprocess");
+        modes.push_back("collective");
+    } else {
+        modes.push_back(writemode);
+    }
+    MPI_Info info = makeInfo(subset);
+
+    // Receive buffers in the pipelined mode's ring, each a whole integration
+    const int depth = std::max(1, subset.getInt32("pipeline.depth", 2));
+
+    // Channels per segment and segment buffers in the segmented mode
+    const int segmentChan = std::min(channels, std::max(1, subset.getInt32("segment.nchan", 64)));
+    const int segmentBuffers = subset.getInt32("segment.buffers", 4);
+
+    // Streams, block size, O_DIRECT and a file per stream in the striped mode
+    const int stripeStreams = subset.getInt32("stripe.streams", 4);
+    const int stripeBlock = subset.getInt32("stripe.blocksize", BLOCKSIZE);
+    const bool stripeDirect = subset.getBool("stripe.direct", false);
+    const bool stripeFiles = subset.getBool("stripe.files", false);
+
+    // Depth and full-queue policy of the queued mode, and where it spills
+    const int queueDepth = subset.getInt32("queue.depth", 4);
+    IngestQueue::Policy queuePolicy = IngestQueue::BLOCK;
+    const std::string policyName = subset.getString("queue.policy", "block");
+    if (!IngestQueue::parse(policyName, queuePolicy) && rank == 0) {
+        std::cout << "WARNING - unknown queue policy " << policyName << ", using block" << std::endl;
+    }
+    const std::string spillDir = subset.getString("queue.spilldir", "/tmp");
+
+    // Integration slots in the shm mode's shared-memory ring
+    const int shmDepth = std::max(1, subset.getInt32("shm.depth", 2));
+
+    // Writers in the hierarchical mode, and whether to follow the paced run
+    // with an unpaced pass timing hierarchical and flat gathers of the same
+    // data
+    const int hierWriters = std::max(1, subset.getInt32("hier.writers", 1));
+    const bool hierCompare = subset.getBool("hier.compare", false);
+
     if (rank == 0) {
         std::cout << "Gathering and Writing " << integrations << " integrations of " << intTime << " seconds " << std::endl;
         std::cout << "There are " << wsize << " blocks of " << channels << " channels " << std::endl;
@@ -170,61 +1456,68 @@ int main(int argc, char *argv[])
         }
     }
 
-    for (int i = 0; i < integrations; ++i) {
-
-        if (i==0 || i%intPerFile == 0) {
-            if (fptr != NULL) {
-                fclose(fptr);
-            }
-            std::ostringstream oss;
-            oss << filename << "_" << i << ".dat";
-            fptr = fopen(oss.str().c_str(),"w");
-            assert(fptr);
-            setvbuf(fptr,NULL,recvBufferSize,_IOFBF);
-
-        }
-        timer.mark();
-        doWorkWorker(sBuf);
-        MPI_Gatherv((void *) sBuf,nElements,MPI_FLOAT,(void *) rBuf,rcounts,displs,MPI_FLOAT,0,MPI_COMM_WORLD);
-        MPI_Barrier(MPI_COMM_WORLD);
-
-        // Report progress
+    std::vector<double> busy(modes.size(), 0.0);
+    std::vector<double> cpu(modes.size(), 0.0);
+    std::vector<double> cpuRoot(modes.size(), 0.0);
+    for (size_t m = 0; m < modes.size(); ++m) {
         if (rank == 0) {
-            const float realtime = timer.real();
-            const float perf = static_cast<float>(intTime) / realtime;
-            if (perf < 1) {
-                std::cout << "WARNING ";
-            }
-            std::cout << "Received integration " << i <<
-            " in " << realtime << " seconds"
-            << " (" << perf << "x requirement)" << std::endl;
-            std::cout << "Doing some work" << std::endl;
-            float workTime;
-            doWorkRoot(rBuf,recvBufferSize,&workTime,fptr);
-            std::cout << "Wrote integration " << i <<  " in "
-            << workTime << " seconds" << std::endl;
-            float combinedTime = workTime + realtime;
-            if (combinedTime < intTime) {
-                useconds_t timetosleep = (useconds_t) 1000.0*(intTime-combinedTime);
-                usleep(timetosleep);
-            }
-            else {
-                std::cout << "WARNING combined time greater than integration time" << std::endl;
-            }
+            std::cout << "Write mode " << modes[m] << std::endl;
         }
+        const double cpuStart = cpuSeconds();
+        if (modes[m] == "root") {
+            busy[m] = runRoot(work, sBuf, rBuf, rcounts, displs, rank);
+        } else if (modes[m] == "pipelined") {
+            busy[m] = runPipelined(work, depth, rcounts, displs, rank);
+        } else if (modes[m] == "segmented") {
+            busy[m] = runSegmented(work, segmentChan, segmentBuffers, sBuf, rank, wsize);
+        } else if (modes[m] == "striped") {
+            StripedWriter* writer = (rank == 0) ?
+                new StripedWriter(stripeStreams, stripeBlock, stripeDirect, stripeFiles) : NULL;
+            busy[m] = runStriped(work, writer, sBuf, rcounts, displs, rank);
+            delete writer;
+        } else if (modes[m] == "queued") {
+            IngestQueue* queue = (rank == 0) ?
+                new IngestQueue(recvBufferSize, queueDepth, queuePolicy, filename, intPerFile,
+                        spillDir, intTime) : NULL;
+            busy[m] = runQueued(work, queue, sBuf, rcounts, displs, rank);
+            delete queue;
+        } else if (modes[m] == "shm") {
+            busy[m] = runShm(work, shmDepth, sBuf, rcounts, displs, rank, wsize);
+        } else if (modes[m] == "hierarchical") {
+            busy[m] = runHierarchical(work, hierWriters, hierCompare, sBuf, rBuf, rcounts, displs,
+                    rank);
+        } else if (modes[m] == "fileperprocess") {
+            busy[m] = runFilePerProcess(work, sBuf, rank);
+        } else if (modes[m] == "collective") {
+            busy[m] = runCollective(work, sBuf, rank, info);
+        } else if (rank == 0) {
+            std::cout << "WARNING - unknown write mode " << modes[m] << std::endl;
+        }
+
+        // CPU time the mode cost, over every rank and on the writer
+        const double cpuUsed = cpuSeconds() - cpuStart;
+        MPI_Reduce(&cpuUsed, &cpu[m], 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        cpuRoot[m] = cpuUsed;
     }
 
-    // Report totals
+    // Aggregate bandwidth of each mode, over the time spent gathering and
+    // writing (the sleep to the next integration is not counted)
     if (rank == 0) {
-        const float realtime = total.real();
-        const float perf = static_cast<float>(intTime * integrations) / realtime;
-        std::cout << "Received " << integrations << " integrations "
-            " in " << realtime << " seconds"
-            << " (" << perf << "x requirement)" << std::endl;
-    }
-    if (fptr != NULL) {
-        fclose(fptr);
+        const double mbytes = static_cast<double>(recvBufferSize) * integrations / (1024.0 * 1024.0);
+        for (size_t m = 0; m < modes.size(); ++m) {
+            if (busy[m] > 0.0) {
+                std::cout << "Aggregate bandwidth (" << modes[m] << "): "
+                    << mbytes / busy[m] << " MB/s" << std::endl;
+            }
+        }
+        for (size_t m = 0; m < modes.size(); ++m) {
+            std::cout << "CPU time (" << modes[m] << "): " << cpu[m]
+                << " seconds over all ranks, " << cpuRoot[m] << " on rank 0" << std::endl;
+        }
     }
+    MPI_Info_free(&info);
+    delete integrity;
+
     free(sBuf);
     free(rBuf);
     free(displs);
@@ -31,10 +31,9 @@
 #include <iostream>
 #include <string>
 #include <sstream>
-#include <fstream>
+#include <vector>
 #include <mpi.h>
 #include <pthread.h>
-#include <string.h> // for memcpy
 #include <sys/timeb.h>
 #include <chrono>
 
@@ -43,47 +42,35 @@
 #include "Common/ParameterSet.h"
 #include "casacore/casa/OS/Timer.h"
 
-#define BLOCKSIZE 4*1024*1024
+// Local includes
+#include "ingest/SpscRing.h"
+#include "ingest/LatencyHistogram.h"
+#include "ingest/CornerTurn.h"
+#include "ingest/Metrics.h"
+#include "ingest/Pacer.h"
+#include "ingest/RfiFlagger.h"
 
+#define BLOCKSIZE 4*1024*1024
 
-// the output file
-FILE *fptr=NULL;
 
-// the log file
+// the metrics, in InfluxDB line protocol, written by a background thread
 
-std::ofstream logfile;
+Metrics *metrics = NULL;
 
 int rank, wsize;
 
+// Time func and record it; the line is formatted and written off the timed
+// path. The tag must be a string literal.
 #define INFLUXDB_LOG(func,tag) {\
   { \
-    casa::Timer work; \
-    work.mark(); \
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now(); \
     func; \
-    std::chrono::nanoseconds ns = std::chrono::duration_cast< std::chrono::nanoseconds >(std::chrono::system_clock::now().time_since_epoch()); \
-    logfile << tag  << "rank=" << rank << " " << "time_secs=" << work.real() << " " << ns.count() << std::endl; \
+    metrics->record(tag, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()); \
   } \
 }
-#define TIME_FUNC(func,tag) { \
-    { \
-        casa::Timer work; \
-        work.mark(); \
-        func; \
-        std::cout << "#" << tag << ":" << work.real() << std::endl; \
-    } \
-}
 // Using
 using LOFAR::ParameterSet;
 
-
-/* the mutex lock */
-
-pthread_mutex_t full_lock;
-pthread_mutex_t swap_lock;
-
-pthread_cond_t buffer_full;
-pthread_cond_t buffer_swapped;
-
 static ParameterSet getParameterSet(int argc, char *argv[])
 {
     cmdlineparser::Parser parser;
@@ -127,71 +114,169 @@ void doWrite(FILE *fptr,size_t towrite,size_t write_block,char *buffptr) {
       }
   }
 }
-void doWorkRoot(void *buffer, size_t buffsize, float *workTime,FILE *fptr) {
-
-
-    casa::Timer work;
-
-
-    int rtn=0;
-
-
-    TIME_FUNC(pthread_mutex_lock(&swap_lock),"mutex action=aquire,");
-    std::cout << "#Write: released the swap lock and waiting for signal" << std::endl;
-    // wait and release lock
-    TIME_FUNC(pthread_cond_wait(&buffer_swapped,&swap_lock),"mutex action=wait,");
-
-    std::cout << "#Write: acquired the swap lock" << std::endl;
-
-    size_t towrite=buffsize;
-    size_t write_block=BLOCKSIZE;
-    char * buffptr= (char *) buffer;
-    work.mark();
-    // here's hoping this is recursive
-    INFLUXDB_LOG(doWrite(fptr,towrite,write_block,buffptr),"file action=write,");
+void doWorkWorker(void *buffer) {
 
-    TIME_FUNC(pthread_mutex_unlock(&swap_lock),"mutex action=unlock,");
-    *workTime = work.real();
-    std::cout << "#Write:Actual write:" << *workTime << std::endl;
+}
 
+// Complex Gaussian noise in [baseline][chan][series] order, with strong
+// narrowband RFI every 101 channels and a weaker band of 8 channels, for
+// the flagger to find. Filled once, so it costs the gather loop nothing.
+static void fillVisibilities(float *buffer, size_t baselines, size_t channels, size_t series)
+{
+    uint64_t state = 0x9e3779b97f4a7c15ULL + rank;
+    const size_t n = baselines * channels * series * 2;
+    for (size_t i = 0; i < n; ++i) {
+        // Sum of four uniforms, scaled to unit variance
+        float x = 0.0f;
+        for (int k = 0; k < 4; ++k) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            x += static_cast<float>(state >> 40) / static_cast<float>(1 << 24);
+        }
+        buffer[i] = (x - 2.0f) * 1.7320508f;
+    }
+    const size_t band = channels / 4;
+    for (size_t b = 0; b < baselines; ++b) {
+        for (size_t c = 0; c < channels; ++c) {
+            const float rfi = (c % 101 == 37) ? 10.0f : (c >= band && c < band + 8) ? 2.0f : 0.0f;
+            if (rfi > 0.0f) {
+                for (size_t s = 0; s < series; ++s) {
+                    buffer[((b * channels + c) * series + s) * 2] += rfi;
+                }
+            }
+        }
+    }
+}
 
+// Start-time jitter, drift and overruns of every rank, printed by rank 0
+static void reportPacing(const Pacer& pacer)
+{
+    double mine[5] = { pacer.jitter().mean(), pacer.jitter().percentile(99.0),
+        pacer.jitter().max(), pacer.drift(), static_cast<double>(pacer.late()) };
+    std::vector<double> all(5 * wsize);
+    MPI_Gather(mine, 5, MPI_DOUBLE, &all[0], 5, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        for (int r = 0; r < wsize; ++r) {
+            const double* v = &all[5 * r];
+            std::cout << "#Rank " << r << " start jitter (s): mean " << v[0]
+                << ", p99 " << v[1] << ", max " << v[2] << ", final drift " << v[3]
+                << ", " << v[4] << " late" << std::endl;
+        }
+    }
 }
-void doWorkWorker(void *buffer) {
 
+static long long nowNs(void)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
+// Shared by the gather loop and the writer thread. The integration buffers
+// are passed by index: the gather loop takes a free index, gathers into
+// that buffer and pushes the index to full; the writer thread writes the
+// buffer and pushes the index back to free. A buffer belongs to one thread
+// at a time, so nothing is copied or locked. An index of -1 stops the
+// writer thread.
 typedef struct {
-    char *in;
-    char *out;
-    size_t nelements;
-    int intTime;
+    std::vector<float*> buffers;
+    std::vector<int> integration;
+    std::vector<long long> handedOff;
+    SpscRing<int>* full;
+    SpscRing<int>* free;
+    size_t bufferSize;
+    int intPerFile;
+    std::string filename;
+    double workTime;
+    CornerTurn* turn;
+    size_t nBlocks;
+    float* turned;
+    LatencyHistogram* handoff;
+    LatencyHistogram* turnTime;
+    LatencyHistogram* write;
+    RfiFlagger* flagger;
+    uint64_t* flags;
+    size_t flagged;
+    LatencyHistogram* flagTime;
 } thread_args ;
 
 /* this function is run by the second thread */
 void *thread_x(void *arg)
 {
-
     thread_args *x_ptr = (thread_args *) arg;
-    while (1) {
-        // wait for a full buffer
-        TIME_FUNC(pthread_mutex_lock (&full_lock),"mutex action=lock,");
-        std::cout << "#Worker: releasing full_lock and waiting" << std::endl;
-        TIME_FUNC(pthread_cond_wait(&buffer_full,&full_lock),"mutex action=wait,");
-        std::cout << "#Worker: acquired full_lock" << std::endl;
-        // release wait and release lock
-        // do something
-        usleep(x_ptr->intTime*1E6);
-        INFLUXDB_LOG(memcpy(x_ptr->out, x_ptr->in,x_ptr->nelements*sizeof(float)),"memory,action=copy,");
+    FILE *fptr=NULL;
+    FILE *flagPtr=NULL;
+    casa::Timer work;
+
+    for (;;) {
+        const int idx = x_ptr->full->popWait();
+        if (idx < 0) {
+            break;
+        }
+        const double handoff = 1e-9 * (nowNs() - x_ptr->handedOff[idx]);
+        x_ptr->handoff->record(handoff);
+        metrics->record("ring,action=handoff,", handoff);
+
+        const int i = x_ptr->integration[idx];
+        if (i==0 || i%x_ptr->intPerFile == 0) {
+            if (fptr != NULL) {
+                fclose(fptr);
+            }
+            std::ostringstream oss;
+            oss << x_ptr->filename << "_" << i << ".dat";
+            fptr = fopen(oss.str().c_str(),"w");
+            assert(fptr);
+            setvbuf(fptr,NULL,x_ptr->bufferSize,_IOFBF);
+
+            // The flags of the same integrations, in the gathered order
+            if (x_ptr->flagger != NULL) {
+                if (flagPtr != NULL) {
+                    fclose(flagPtr);
+                }
+                std::ostringstream flagName;
+                flagName << x_ptr->filename << "_" << i << "_flags.dat";
+                flagPtr = fopen(flagName.str().c_str(),"w");
+                assert(flagPtr);
+            }
+        }
 
-        TIME_FUNC(pthread_mutex_unlock (&full_lock),"mutex action=unlock,");
-        TIME_FUNC(pthread_mutex_lock (&swap_lock),"mutex action=lock,");
-        TIME_FUNC(pthread_cond_signal(&buffer_swapped),"mutex action=signal,");
-        TIME_FUNC(pthread_mutex_unlock (&swap_lock),"mutex action=unlock,");
+        // do something
+        if (x_ptr->workTime > 0.0) {
+            usleep(x_ptr->workTime*1E6);
+        }
+        if (x_ptr->flagger != NULL) {
+            work.mark();
+            x_ptr->flagged += x_ptr->flagger->flag(x_ptr->buffers[idx], x_ptr->flags, x_ptr->nBlocks);
+            x_ptr->flagTime->record(work.real());
+            metrics->record("cpu,action=flag,", work.real());
+        }
+        char *out = (char *) x_ptr->buffers[idx];
+        if (x_ptr->turn != NULL) {
+            work.mark();
+            x_ptr->turn->transpose(x_ptr->buffers[idx], x_ptr->turned, x_ptr->nBlocks);
+            x_ptr->turnTime->record(work.real());
+            metrics->record("cpu,action=cornerturn,", work.real());
+            out = (char *) x_ptr->turned;
+        }
+        work.mark();
+        doWrite(fptr,x_ptr->bufferSize,BLOCKSIZE,out);
+        if (x_ptr->flagger != NULL) {
+            doWrite(flagPtr,x_ptr->flagger->flagWords(x_ptr->nBlocks)*sizeof(uint64_t),BLOCKSIZE,
+                    (char *) x_ptr->flags);
+        }
+        x_ptr->write->record(work.real());
+        metrics->record("file,action=write,", work.real());
 
+        x_ptr->free->pushWait(idx);
     }
-}
-void transpose(float *in, float *out) {
 
+    if (fptr != NULL) {
+        fclose(fptr);
+    }
+    if (flagPtr != NULL) {
+        fclose(flagPtr);
+    }
+    return NULL;
 }
 
 
@@ -222,11 +307,6 @@ int main(int argc, char *argv[])
     std::string filename = subset.getString("filename","data");
     std::string logname = subset.getString("logname","test");
 
-    // initialise the mutex lock
-    pthread_mutex_init(&full_lock, NULL);
-    pthread_cond_init (&buffer_full, NULL);
-    pthread_mutex_init(&swap_lock, NULL);
-    pthread_cond_init (&buffer_swapped, NULL);
     // thread attributes
     pthread_t x_thread;
     pthread_attr_t attr;
@@ -243,12 +323,62 @@ int main(int argc, char *argv[])
     int pol = subset.getInt32("nPol",4);
     int maxfilesizeMB = subset.getInt32("maxfilesizeMB",0);
 
+    // Integration buffers in the ring, and seconds of simulated processing
+    // per integration in the writer thread
+    int nBuffers = subset.getInt32("nBuffers",3);
+    if (nBuffers < 2) {
+        nBuffers = 2;
+    }
+    double workTime = subset.getDouble("workTime",0.0);
+
+    // Corner turn to channel-major in the writer thread: none, local (of
+    // the whole gathered integration on rank 0) or distributed (MPI_Alltoallv
+    // gives each rank all channels for its share of the baselines, which
+    // every rank turns and writes)
+    std::string cornerturn = subset.getString("cornerturn","none");
+    int turnThreads = subset.getInt32("cornerturn.threads",4);
+    int turnTile = subset.getInt32("cornerturn.tile",16);
+    if (cornerturn != "none" && cornerturn != "local" && cornerturn != "distributed") {
+        if (rank == 0) {
+            std::cout << "#WARNING - unknown cornerturn " << cornerturn << ", using none" << std::endl;
+        }
+        cornerturn = "none";
+    }
+    const bool distributed = (cornerturn == "distributed");
+
+    // SumThreshold RFI flagging of each integration in the writer thread,
+    // before any corner turn, on synthetic visibilities; the flags are
+    // written beside the data, a bit per complex sample
+    const bool rfi = subset.getBool("rfi",false);
+    int rfiThreads = subset.getInt32("rfi.threads",4);
+    double rfiThreshold = subset.getDouble("rfi.threshold",6.0);
+    int rfiWindow = subset.getInt32("rfi.maxwindow",32);
+    const bool writer = (rank == 0 || distributed);
+
     int baselines = (antennas*(antennas-1)/2);
 
     size_t nElements = baselines*channels*beams*pol*2;
     size_t sendBufferSize = nElements*sizeof(float);
     size_t recvBufferSize = wsize*sendBufferSize;
 
+    // Baselines [firstBaseline[r], firstBaseline[r+1]) go to rank r when
+    // the corner turn is distributed
+    const size_t inner = beams*pol*2;
+    std::vector<int> firstBaseline(wsize + 1);
+    for (int r = 0; r <= wsize; ++r) {
+        firstBaseline[r] = (static_cast<long>(baselines) * r) / wsize;
+    }
+    const int myBaselines = firstBaseline[rank + 1] - firstBaseline[rank];
+    std::vector<int> sendcounts(wsize), sdispls(wsize), recvcounts(wsize), rdispls(wsize);
+    for (int r = 0; r < wsize; ++r) {
+        sendcounts[r] = (firstBaseline[r + 1] - firstBaseline[r]) * channels * inner;
+        sdispls[r] = firstBaseline[r] * channels * inner;
+        recvcounts[r] = myBaselines * channels * inner;
+        rdispls[r] = r * recvcounts[r];
+    }
+    const size_t bufferSize = distributed ?
+        static_cast<size_t>(wsize) * recvcounts[0] * sizeof(float) : recvBufferSize;
+
     int intPerFile = integrations;
 
     if (maxfilesizeMB != 0) {
@@ -259,13 +389,60 @@ int main(int argc, char *argv[])
 
 
     float *sBuf = (float *) malloc(sendBufferSize);
-    float *rBuf = (float *) malloc(recvBufferSize);
-    float *oBuf = (float *) malloc(recvBufferSize);
+    if (rfi) {
+        fillVisibilities(sBuf, baselines, channels, beams*pol);
+    }
 
-    work_dat.in = (char *) rBuf;
-    work_dat.out = (char *) oBuf;
-    work_dat.nelements = wsize*nElements;
-    work_dat.intTime = intTime;
+    LatencyHistogram handoffHist("Handoff", intTime);
+    LatencyHistogram writeHist("Write", intTime);
+    LatencyHistogram turnHist("Corner turn", intTime);
+    LatencyHistogram flagHist("RFI flagging", intTime);
+    LatencyHistogram gatherHist("Gather", intTime);
+    LatencyHistogram waitHist("Buffer wait", intTime);
+
+    // Only the ranks that write need the ring
+    SpscRing<int> fullRing(nBuffers + 1);
+    SpscRing<int> freeRing(nBuffers);
+    if (writer) {
+        for (int b = 0; b < nBuffers; ++b) {
+            work_dat.buffers.push_back((float *) malloc(bufferSize));
+            freeRing.push(b);
+        }
+    }
+    CornerTurn turn(distributed ? myBaselines : baselines, channels, inner, turnThreads, turnTile);
+    work_dat.turn = NULL;
+    work_dat.turned = NULL;
+    if (writer && cornerturn != "none") {
+        work_dat.turn = &turn;
+        work_dat.turned = (float *) malloc(bufferSize);
+    }
+    work_dat.nBlocks = wsize;
+    RfiFlagger flagger(distributed ? myBaselines : baselines, channels, beams*pol, rfiThreads,
+            rfiThreshold, rfiWindow);
+    work_dat.flagger = NULL;
+    work_dat.flags = NULL;
+    work_dat.flagged = 0;
+    work_dat.flagTime = &flagHist;
+    if (writer && rfi) {
+        work_dat.flagger = &flagger;
+        work_dat.flags = (uint64_t *) malloc(flagger.flagWords(wsize)*sizeof(uint64_t));
+    }
+    work_dat.turnTime = &turnHist;
+    work_dat.integration.assign(nBuffers, 0);
+    work_dat.handedOff.assign(nBuffers, 0);
+    work_dat.full = &fullRing;
+    work_dat.free = &freeRing;
+    work_dat.bufferSize = bufferSize;
+    work_dat.intPerFile = intPerFile;
+    work_dat.filename = filename;
+    if (distributed) {
+        std::ostringstream name;
+        name << filename << "_" << rank;
+        work_dat.filename = name.str();
+    }
+    work_dat.workTime = workTime;
+    work_dat.handoff = &handoffHist;
+    work_dat.write = &writeHist;
 
     int *displs = (int *)malloc(wsize*sizeof(int));
     int *rcounts = (int *)malloc(wsize*sizeof(int));
@@ -275,15 +452,28 @@ int main(int argc, char *argv[])
        rcounts[i] = nElements;
     }
 
-    //open the logptr
+    // Metrics go to logname_rank.log by default, or to the metrics target:
+    // a file name (%w is replaced by the rank), udp:host:port or unix:/path
     std::ostringstream oss;
     oss << logname << "_" << rank << ".log";
-    logfile.open(oss.str().c_str(), std::ios::out | std::ios::trunc);
+    std::string target = subset.getString("metrics",oss.str());
+    const size_t w = target.find("%w");
+    if (w != std::string::npos) {
+        std::ostringstream r;
+        r << rank;
+        target.replace(w, 2, r.str());
+    }
+    metrics = new Metrics(target, rank, subset.getInt32("metrics.capacity",4096),
+            subset.getInt32("metrics.interval",100));
+    const double recordCost = metrics->calibrate();
 
 
     casa::Timer timer;
+    casa::Timer wait;
     casa::Timer total;
+    double headroom = 0.0;
     total.mark();
+    Pacer pacer(intTime);
     if (rank == 0) {
         std::cout << "#Gathering and Writing " << integrations << " integrations of " << intTime << " seconds " << std::endl;
         std::cout << "#There are " << wsize << " blocks of " << channels << " channels " << std::endl;
@@ -293,6 +483,17 @@ int main(int argc, char *argv[])
         if (maxfilesizeMB !=0) {
             std::cout << "#Integrations per file " << intPerFile << std::endl;
         }
+        std::cout << "#Ring of " << nBuffers << " integration buffers" << std::endl;
+        if (cornerturn != "none") {
+            std::cout << "#Corner turn (" << cornerturn << ") with " << turn.threads()
+                << " threads" << std::endl;
+        }
+        if (rfi) {
+            std::cout << "#RFI flagging with " << flagger.threads() << " threads, threshold "
+                << rfiThreshold << " sigma, windows up to " << rfiWindow << " channels" << std::endl;
+        }
+    }
+    if (writer) {
         // Spawn a thread
 
 
@@ -309,56 +510,59 @@ int main(int argc, char *argv[])
 
     for (int i = 0; i < integrations; ++i) {
 
-        if (i==0 || i%intPerFile == 0) {
-            if (fptr != NULL) {
-                INFLUXDB_LOG(fclose(fptr),"file,action=close,");
-            }
-            std::ostringstream oss;
-            oss << filename << "_" << i << ".dat";
-            fptr = fopen(oss.str().c_str(),"w");
-            assert(fptr);
-            setvbuf(fptr,NULL,recvBufferSize,_IOFBF);
-
-        }
         timer.mark();
+        pacer.start();
         doWorkWorker(sBuf);
 
-        if (rank == 0) {
-            TIME_FUNC(pthread_mutex_lock(&full_lock),"mutex action=lock,");
-            std::cout << "#Starting the Gathering" << std::endl;
+        // Take a free buffer, waiting only if the writer is a whole ring
+        // behind
+        int idx = 0;
+        float *rBuf = NULL;
+        if (writer) {
+            wait.mark();
+            idx = freeRing.popWait();
+            waitHist.record(wait.real());
+            metrics->record("ring,action=wait,", wait.real());
+            rBuf = work_dat.buffers[idx];
+        }
+        if (distributed) {
+            INFLUXDB_LOG(MPI_Alltoallv((void *) sBuf,&sendcounts[0],&sdispls[0],MPI_FLOAT,(void *) rBuf,&recvcounts[0],&rdispls[0],MPI_FLOAT,MPI_COMM_WORLD),"mpi,action=alltoall,");
+        }
+        else {
+            INFLUXDB_LOG(MPI_Gatherv((void *) sBuf,nElements,MPI_FLOAT,(void *) rBuf,rcounts,displs,MPI_FLOAT,0,MPI_COMM_WORLD),"mpi,action=gather,");
+        }
+        if (writer) {
+            work_dat.integration[idx] = i;
+            work_dat.handedOff[idx] = nowNs();
+            fullRing.pushWait(idx);
         }
-        INFLUXDB_LOG(MPI_Gatherv((void *) sBuf,nElements,MPI_FLOAT,(void *) rBuf,rcounts,displs,MPI_FLOAT,0,MPI_COMM_WORLD),"mpi,action=gather,");
         MPI_Barrier(MPI_COMM_WORLD);
 
         // Report progress
         if (rank == 0) {
             const float realtime = timer.real();
             const float perf = static_cast<float>(intTime) / realtime;
+            gatherHist.record(realtime);
+            headroom += 1.0 - realtime / intTime;
             if (perf < 1) {
                 std::cout << "#WARNING ";
             }
             std::cout << "#MPI Gather for integration " << i <<
             " in " << realtime << " seconds"
             << " (" << perf << "x requirement)" << std::endl;
+        }
 
+        // Next integration from the correlator
+        pacer.wait();
+    }
 
-            TIME_FUNC(pthread_cond_signal(&buffer_full),"mutex action=signal,");
-            TIME_FUNC(pthread_mutex_unlock(&full_lock),"mutex action=unlock,");
-
-            float workTime;
-
-
-            // aquire lock
-            //first get the lock so things stay sync'd
-
-            INFLUXDB_LOG(doWorkRoot(rBuf,recvBufferSize,&workTime,fptr),"file,action=write,");
-
-
-
-            // release lock
-        }
+    if (writer) {
+        fullRing.pushWait(-1);
+        pthread_join(x_thread, NULL);
     }
 
+    reportPacing(pacer);
+
     // Report totals
     if (rank == 0) {
         const float realtime = total.real();
@@ -366,25 +570,59 @@ int main(int argc, char *argv[])
         std::cout << "#Received " << integrations << " integrations "
             " in " << realtime << " seconds"
             << " (" << perf << "x requirement)" << std::endl;
-    }
-    if (fptr != NULL) {
-        fclose(fptr);
+        std::cout << "#";
+        gatherHist.report(std::cout);
+        std::cout << "#";
+        waitHist.report(std::cout);
+        std::cout << "#";
+        handoffHist.report(std::cout);
+        std::cout << "#";
+        writeHist.report(std::cout);
+        if (turnHist.count() > 0) {
+            std::cout << "#";
+            turnHist.report(std::cout);
+            const double gbytes = bufferSize / (1024.0 * 1024.0 * 1024.0);
+            const double rate = gbytes / turnHist.mean();
+            const double ingest = gbytes / intTime;
+            std::cout << "#Corner turn " << rate << " GB/s per rank, "
+                << rate / ingest << "x the ingest rate of " << ingest << " GB/s" << std::endl;
+        }
+
+        if (flagHist.count() > 0) {
+            std::cout << "#";
+            flagHist.report(std::cout);
+            const double samples = static_cast<double>(flagger.samples(wsize));
+            const double rate = samples / flagHist.mean();
+            const double needed = samples / intTime;
+            std::cout << "#RFI flagging " << rate / 1e6 << " Msamples/s per rank, "
+                << rate / needed << "x the " << needed / 1e6
+                << " Msamples/s needed to keep up, "
+                << 100.0 * work_dat.flagged / (samples * flagHist.count())
+                << "% of samples flagged" << std::endl;
+        }
+
+        // The gather loop's critical path is the gather plus any wait for a
+        // free buffer; the writes it used to do in line now overlap
+        if (integrations > 0) {
+            std::cout << "#Headroom " << 100.0 * headroom / integrations
+                << "% of the integration time, with " << writeHist.mean()
+                << " seconds of writing per integration moved off the gather loop" << std::endl;
+        }
     }
 
-    if (logfile.is_open()) {
-      logfile.close();
+    if (rank == 0) {
+        std::cout << "#Metrics: " << metrics->events() << " events recorded at "
+            << 1e9 * recordCost << " ns each, " << metrics->dropped() << " dropped" << std::endl;
     }
+    delete metrics;
     pthread_attr_destroy(&attr);
-    // pthread_kill(x_thread,SIGKILL);
-    // pthread_join(x_thread, NULL);
-    pthread_mutex_destroy(&full_lock);
-    pthread_mutex_destroy(&swap_lock);
-    pthread_cond_destroy(&buffer_full);
-    pthread_cond_destroy(&buffer_swapped);
 
     free(sBuf);
-    free(rBuf);
-    free(oBuf);
+    for (size_t b = 0; b < work_dat.buffers.size(); ++b) {
+        free(work_dat.buffers[b]);
+    }
+    free(work_dat.turned);
+    free(work_dat.flags);
     free(displs);
     free(rcounts);
     MPI_Finalize();
@@ -0,0 +1,105 @@
+/// @file CornerTurn.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "CornerTurn.h"
+
+// System includes
+#include <vector>
+#include <algorithm>
+#include <pthread.h>
+
+CornerTurn::CornerTurn(size_t baselines, size_t channels, size_t inner, int threads,
+        size_t tile)
+: itsBaselines(baselines), itsChannels(channels), itsInner(inner),
+    itsThreads(std::max(1, threads)), itsTile(std::max(static_cast<size_t>(1), tile))
+{
+}
+
+void CornerTurn::transpose(const float* in, float* out, size_t nBlocks) const
+{
+    // Each task takes a run of channel tiles, whole rows of the output
+    const size_t perBlock = (itsChannels + itsTile - 1) / itsTile;
+    const size_t nTiles = nBlocks * perBlock;
+    const size_t nTasks = std::min(static_cast<size_t>(itsThreads), std::max(nTiles,
+                static_cast<size_t>(1)));
+
+    std::vector<Task> tasks(nTasks);
+    for (size_t t = 0; t < nTasks; ++t) {
+        tasks[t].turn = this;
+        tasks[t].in = in;
+        tasks[t].out = out;
+        tasks[t].first = nTiles * t / nTasks;
+        tasks[t].last = nTiles * (t + 1) / nTasks;
+    }
+
+    // The calling thread does the first share
+    std::vector<pthread_t> threads(nTasks);
+    std::vector<bool> started(nTasks, false);
+    for (size_t t = 1; t < nTasks; ++t) {
+        started[t] = pthread_create(&threads[t], 0, &CornerTurn::run, &tasks[t]) == 0;
+    }
+    run(&tasks[0]);
+    for (size_t t = 1; t < nTasks; ++t) {
+        if (started[t]) {
+            pthread_join(threads[t], 0);
+        } else {
+            run(&tasks[t]);
+        }
+    }
+}
+
+void* CornerTurn::run(void* arg)
+{
+    const Task* task = static_cast<const Task*>(arg);
+    task->turn->turnTiles(task->in, task->out, task->first, task->last);
+    return 0;
+}
+
+void CornerTurn::turnTiles(const float* in, float* out, size_t first, size_t last) const
+{
+    const size_t perBlock = (itsChannels + itsTile - 1) / itsTile;
+    const size_t nInner = itsInner;
+
+    for (size_t tile = first; tile < last; ++tile) {
+        const size_t block = tile / perBlock;
+        const size_t c0 = (tile % perBlock) * itsTile;
+        const size_t c1 = std::min(c0 + itsTile, itsChannels);
+        const float* src = in + block * blockSize();
+        float* dst = out + block * blockSize();
+
+        for (size_t b0 = 0; b0 < itsBaselines; b0 += itsTile) {
+            const size_t b1 = std::min(b0 + itsTile, itsBaselines);
+            for (size_t c = c0; c < c1; ++c) {
+                for (size_t b = b0; b < b1; ++b) {
+                    const float* __restrict__ from = src + (b * itsChannels + c) * nInner;
+                    float* __restrict__ to = dst + (c * itsBaselines + b) * nInner;
+                    for (size_t i = 0; i < nInner; ++i) {
+                        to[i] = from[i];
+                    }
+                }
+            }
+        }
+    }
+}
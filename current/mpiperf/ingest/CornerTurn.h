@@ -0,0 +1,75 @@
+/// @file CornerTurn.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef CORNERTURN_H
+#define CORNERTURN_H
+
+// System includes
+#include <cstddef>
+
+/// Corner turn of gathered visibilities from baseline-major
+/// [block][baseline][chan][beam][pol] to channel-major
+/// [block][chan][baseline][beam][pol], as imaging wants them. A block is
+/// the slice from one rank, so block-major plus channel-major is the global
+/// channel order.
+///
+/// Each block is a baselines x channels matrix whose elements are the
+/// contiguous beam x pol complex values (inner floats). It is transposed
+/// tile by tile so both the rows read and the rows written stay in cache,
+/// and the tiles are shared out between threads. The inner copy is a plain
+/// loop the compiler vectorises.
+class CornerTurn
+{
+    public:
+        CornerTurn(size_t baselines, size_t channels, size_t inner, int threads = 1,
+                size_t tile = 16);
+
+        /// Transpose nBlocks blocks from in to out, which must not overlap
+        void transpose(const float* in, float* out, size_t nBlocks) const;
+
+        size_t blockSize(void) const { return itsBaselines * itsChannels * itsInner; }
+        int threads(void) const { return itsThreads; }
+
+    private:
+        struct Task {
+            const CornerTurn* turn;
+            const float* in;
+            float* out;
+            size_t first;
+            size_t last;
+        };
+
+        static void* run(void* arg);
+
+        // Transpose tiles [first, last), counted over all blocks
+        void turnTiles(const float* in, float* out, size_t first, size_t last) const;
+
+        size_t itsBaselines;
+        size_t itsChannels;
+        size_t itsInner;
+        int itsThreads;
+        size_t itsTile;
+};
+
+#endif
@@ -0,0 +1,122 @@
+/// @file Crc32c.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "Crc32c.h"
+
+// System includes
+#include <cstring>
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+// Reflected Castagnoli polynomial
+static const uint32_t poly = 0x82f63b78;
+
+// Slicing-by-8 tables, built on first use
+struct Crc32cTables {
+    uint32_t t[8][256];
+
+    Crc32cTables() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? (c >> 1) ^ poly : c >> 1;
+            }
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int s = 1; s < 8; ++s) {
+                t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xff];
+            }
+        }
+    }
+};
+
+static uint32_t crcSoftware(uint32_t c, const unsigned char* p, size_t n)
+{
+    static const Crc32cTables tables;
+    const uint32_t (*t)[256] = tables.t;
+    while (n >= 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= c;
+        c = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24]
+            ^ t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+        p += 8;
+        n -= 8;
+    }
+    while (n--) {
+        c = (c >> 8) ^ t[0][(c ^ *p++) & 0xff];
+    }
+    return c;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2")))
+static uint32_t crcHardware(uint32_t c, const unsigned char* p, size_t n)
+{
+    uint64_t c64 = c;
+    while (n >= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        c64 = _mm_crc32_u64(c64, v);
+        p += 8;
+        n -= 8;
+    }
+    c = static_cast<uint32_t>(c64);
+    while (n--) {
+        c = _mm_crc32_u8(c, *p++);
+    }
+    return c;
+}
+
+static bool hasHardware(void)
+{
+    static const bool has = __builtin_cpu_supports("sse4.2");
+    return has;
+}
+#endif
+
+uint32_t crc32c(const void* data, size_t n, uint32_t crc)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+#if defined(__x86_64__)
+    if (hasHardware()) {
+        return ~crcHardware(~crc, p, n);
+    }
+#endif
+    return ~crcSoftware(~crc, p, n);
+}
+
+const char* crc32cImplementation(void)
+{
+#if defined(__x86_64__)
+    if (hasHardware()) {
+        return "SSE4.2";
+    }
+#endif
+    return "software";
+}
@@ -0,0 +1,40 @@
+/// @file Crc32c.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef CRC32C_H
+#define CRC32C_H
+
+// System includes
+#include <cstddef>
+#include <stdint.h>
+
+/// CRC32C (Castagnoli) of n bytes, continuing from crc (0 to start). Uses
+/// the SSE4.2 crc32 instruction when the CPU has it, chosen at run time so
+/// the build needs no special flags, and a slicing-by-8 table otherwise.
+uint32_t crc32c(const void* data, size_t n, uint32_t crc = 0);
+
+/// Which implementation crc32c() uses on this CPU
+const char* crc32cImplementation(void);
+
+#endif
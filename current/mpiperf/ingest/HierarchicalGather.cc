@@ -0,0 +1,127 @@
+/// @file HierarchicalGather.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "HierarchicalGather.h"
+
+// System includes
+#include <algorithm>
+
+HierarchicalGather::HierarchicalGather(MPI_Comm comm, size_t count, int writers)
+: itsCount(count), itsGroup(MPI_COMM_NULL), itsNodes(0), itsWriter(-1),
+    itsNodeTime(0.0), itsInterTime(0.0)
+{
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Type_contiguous(static_cast<int>(itsCount), MPI_FLOAT, &itsSlice);
+    MPI_Type_commit(&itsSlice);
+
+    // The node's ranks, in comm order so the leader is the lowest
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &itsNode);
+    MPI_Comm_size(itsNode, &itsNodeSize);
+    int nodeRank;
+    MPI_Comm_rank(itsNode, &nodeRank);
+    const bool leader = (nodeRank == 0);
+
+    MPI_Comm leaders;
+    MPI_Comm_split(comm, leader ? 0 : MPI_UNDEFINED, rank, &leaders);
+    int leaderIndex = 0;
+    if (leader) {
+        MPI_Comm_size(leaders, &itsNodes);
+        MPI_Comm_rank(leaders, &leaderIndex);
+    }
+    MPI_Bcast(&itsNodes, 1, MPI_INT, 0, itsNode);
+    itsWriters = std::max(1, std::min(writers, itsNodes));
+
+    // Contiguous groups of nodes, each gathered by its lowest leader
+    if (leader) {
+        const int group = static_cast<int>(static_cast<long>(leaderIndex) * itsWriters / itsNodes);
+        MPI_Comm_split(leaders, group, leaderIndex, &itsGroup);
+        MPI_Comm_free(&leaders);
+        int groupRank;
+        MPI_Comm_rank(itsGroup, &groupRank);
+        if (groupRank == 0) {
+            itsWriter = group;
+        }
+    }
+
+    // Which comm rank each slice comes from, first on the node and then
+    // in the writer's group
+    std::vector<int> nodeRanks(itsNodeSize);
+    MPI_Gather(&rank, 1, MPI_INT, &nodeRanks[0], 1, MPI_INT, 0, itsNode);
+    if (leader) {
+        int groupSize;
+        MPI_Comm_size(itsGroup, &groupSize);
+        if (writer()) {
+            itsGroupCounts.resize(groupSize);
+            itsGroupDispls.resize(groupSize);
+        }
+        MPI_Gather(&itsNodeSize, 1, MPI_INT, writer() ? &itsGroupCounts[0] : NULL, 1, MPI_INT,
+                0, itsGroup);
+        if (writer()) {
+            int total = 0;
+            for (int g = 0; g < groupSize; ++g) {
+                itsGroupDispls[g] = total;
+                total += itsGroupCounts[g];
+            }
+            itsRanks.resize(total);
+        }
+        MPI_Gatherv(&nodeRanks[0], itsNodeSize, MPI_INT, writer() ? &itsRanks[0] : NULL,
+                writer() ? &itsGroupCounts[0] : NULL, writer() ? &itsGroupDispls[0] : NULL,
+                MPI_INT, 0, itsGroup);
+
+        // A writer aggregates its own node in place in the receive buffer
+        if (!writer()) {
+            itsNodeBuffer.resize(static_cast<size_t>(itsNodeSize) * itsCount);
+        }
+    }
+}
+
+HierarchicalGather::~HierarchicalGather()
+{
+    if (itsGroup != MPI_COMM_NULL) {
+        MPI_Comm_free(&itsGroup);
+    }
+    MPI_Comm_free(&itsNode);
+    MPI_Type_free(&itsSlice);
+}
+
+void HierarchicalGather::gather(const float* send, float* recv)
+{
+    const double start = MPI_Wtime();
+    float* aggregate = writer() ? recv : (itsNodeBuffer.empty() ? NULL : &itsNodeBuffer[0]);
+    MPI_Gather(const_cast<float*>(send), 1, itsSlice, aggregate, 1, itsSlice, 0, itsNode);
+    const double nodeDone = MPI_Wtime();
+    itsNodeTime = nodeDone - start;
+
+    if (itsGroup != MPI_COMM_NULL) {
+        if (writer()) {
+            MPI_Gatherv(MPI_IN_PLACE, 0, itsSlice, recv, &itsGroupCounts[0], &itsGroupDispls[0],
+                    itsSlice, 0, itsGroup);
+        } else {
+            MPI_Gatherv(aggregate, itsNodeSize, itsSlice, NULL, NULL, NULL, itsSlice, 0, itsGroup);
+        }
+    }
+    itsInterTime = MPI_Wtime() - nodeDone;
+}
@@ -0,0 +1,87 @@
+/// @file HierarchicalGather.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef HIERARCHICALGATHER_H
+#define HIERARCHICALGATHER_H
+
+// System includes
+#include <vector>
+#include <cstddef>
+#include <mpi.h>
+
+/// Two-level gather. The ranks on each node (found with
+/// MPI_COMM_TYPE_SHARED) first gather to the node's lowest rank, its
+/// leader, and the leaders then gather the node aggregates to the writers,
+/// so each node crosses the network once with one large message. The nodes
+/// are split into contiguous groups, one per writer, and each writer
+/// receives only its group; the first writer is rank 0. A slice counts as
+/// one element, so large integrations do not overflow the int counts.
+class HierarchicalGather
+{
+    public:
+        /// Every rank contributes count floats; writers is capped at the
+        /// number of nodes
+        HierarchicalGather(MPI_Comm comm, size_t count, int writers);
+
+        ~HierarchicalGather();
+
+        /// Gather one integration. On a writer recv receives slices() slices
+        /// of count floats, in the order given by ranks(); elsewhere recv is
+        /// unused. The time of each level is kept for the caller.
+        void gather(const float* send, float* recv);
+
+        /// Whether this rank is a writer, and which
+        bool writer(void) const { return itsWriter >= 0; }
+        int writerIndex(void) const { return itsWriter; }
+        int writers(void) const { return itsWriters; }
+
+        /// Slices a writer receives, and the comm rank each came from
+        std::size_t slices(void) const { return itsRanks.size(); }
+        const std::vector<int>& ranks(void) const { return itsRanks; }
+
+        int nodes(void) const { return itsNodes; }
+        int nodeSize(void) const { return itsNodeSize; }
+
+        /// Seconds in the node and inter-node levels of the last gather
+        double nodeTime(void) const { return itsNodeTime; }
+        double interTime(void) const { return itsInterTime; }
+
+    private:
+        size_t itsCount;
+        MPI_Datatype itsSlice;
+        MPI_Comm itsNode;
+        MPI_Comm itsGroup;
+        int itsNodeSize;
+        int itsNodes;
+        int itsWriters;
+        int itsWriter;
+        std::vector<int> itsGroupCounts;
+        std::vector<int> itsGroupDispls;
+        std::vector<int> itsRanks;
+        std::vector<float> itsNodeBuffer;
+        double itsNodeTime;
+        double itsInterTime;
+};
+
+#endif
@@ -0,0 +1,253 @@
+/// @file IngestQueue.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "IngestQueue.h"
+
+// System includes
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <cassert>
+#include <algorithm>
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds(const Clock::time_point& start, const Clock::time_point& end)
+{
+    return std::chrono::duration<double>(end - start).count();
+}
+
+bool IngestQueue::parse(const std::string& name, Policy& policy)
+{
+    if (name == "block") {
+        policy = BLOCK;
+    } else if (name == "drop-oldest") {
+        policy = DROP_OLDEST;
+    } else if (name == "drop-newest") {
+        policy = DROP_NEWEST;
+    } else if (name == "spill") {
+        policy = SPILL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* IngestQueue::name(Policy policy)
+{
+    switch (policy) {
+        case DROP_OLDEST: return "drop-oldest";
+        case DROP_NEWEST: return "drop-newest";
+        case SPILL: return "spill";
+        default: return "block";
+    }
+}
+
+IngestQueue::IngestQueue(size_t bytes, int depth, Policy policy, const std::string& filename,
+        int perFile, const std::string& spillDir, double deadline)
+: itsBytes(bytes), itsPolicy(policy), itsFilename(filename), itsPerFile(perFile > 0 ? perFile : 1),
+    itsSpillDir(spillDir), itsScratch(NULL), itsInFlight(0), itsStop(false), itsWritten(0),
+    itsHighWater(0), itsWriteHist("Write", deadline), itsQueued(0), itsDropped(0),
+    itsSpilled(0), itsStalls(0), itsStallTime(0.0), itsSpillTime(0.0)
+{
+    if (depth < 1) {
+        depth = 1;
+    }
+    for (int i = 0; i < depth; ++i) {
+        itsBuffers.push_back((float *) malloc(bytes));
+        assert(itsBuffers.back());
+        itsFree.push_back(itsBuffers.back());
+    }
+    if (itsPolicy == DROP_NEWEST || itsPolicy == SPILL) {
+        itsScratch = (float *) malloc(bytes);
+        assert(itsScratch);
+    }
+
+    pthread_mutex_init(&itsLock, 0);
+    pthread_cond_init(&itsChanged, 0);
+    if (pthread_create(&itsThread, 0, &IngestQueue::run, this) != 0) {
+        std::cout << "WARNING - failed to start the writer thread" << std::endl;
+        abort();
+    }
+}
+
+IngestQueue::~IngestQueue()
+{
+    pthread_mutex_lock(&itsLock);
+    itsStop = true;
+    pthread_cond_broadcast(&itsChanged);
+    pthread_mutex_unlock(&itsLock);
+    pthread_join(itsThread, 0);
+
+    pthread_cond_destroy(&itsChanged);
+    pthread_mutex_destroy(&itsLock);
+
+    for (size_t i = 0; i < itsBuffers.size(); ++i) {
+        free(itsBuffers[i]);
+    }
+    free(itsScratch);
+}
+
+float* IngestQueue::acquire(void)
+{
+    const Clock::time_point start = Clock::now();
+    pthread_mutex_lock(&itsLock);
+    float* buffer = NULL;
+    if (itsFree.empty()) {
+        if (itsPolicy == DROP_NEWEST || itsPolicy == SPILL) {
+            buffer = itsScratch;
+        } else if (itsPolicy == DROP_OLDEST && !itsQueue.empty()) {
+            buffer = itsQueue.front().buffer;
+            itsQueue.pop_front();
+            itsDropped++;
+        } else {
+            // Blocking, or every buffer is being written
+            while (itsFree.empty()) {
+                pthread_cond_wait(&itsChanged, &itsLock);
+            }
+            itsStalls++;
+            itsStallTime += seconds(start, Clock::now());
+        }
+    }
+    if (buffer == NULL) {
+        buffer = itsFree.front();
+        itsFree.pop_front();
+    }
+    pthread_mutex_unlock(&itsLock);
+    return buffer;
+}
+
+void IngestQueue::submit(float* buffer, int integration)
+{
+    if (buffer == itsScratch) {
+        if (itsPolicy == SPILL) {
+            const Clock::time_point start = Clock::now();
+            spill(buffer, integration);
+            itsSpillTime += seconds(start, Clock::now());
+            itsSpilled++;
+        } else {
+            itsDropped++;
+        }
+        return;
+    }
+
+    Entry entry;
+    entry.buffer = buffer;
+    entry.integration = integration;
+    pthread_mutex_lock(&itsLock);
+    itsQueue.push_back(entry);
+    itsHighWater = std::max(itsHighWater, itsQueue.size() + itsInFlight);
+    itsQueued++;
+    pthread_cond_broadcast(&itsChanged);
+    pthread_mutex_unlock(&itsLock);
+}
+
+void IngestQueue::flush(void)
+{
+    pthread_mutex_lock(&itsLock);
+    while (!itsQueue.empty() || itsInFlight > 0) {
+        pthread_cond_wait(&itsChanged, &itsLock);
+    }
+    pthread_mutex_unlock(&itsLock);
+}
+
+void* IngestQueue::run(void* arg)
+{
+    static_cast<IngestQueue*>(arg)->writeLoop();
+    return 0;
+}
+
+void IngestQueue::writeLoop(void)
+{
+    FILE* fptr = NULL;
+    int fileStart = -1;
+    pthread_mutex_lock(&itsLock);
+    for (;;) {
+        while (itsQueue.empty() && !itsStop) {
+            pthread_cond_wait(&itsChanged, &itsLock);
+        }
+        if (itsQueue.empty()) {
+            break;
+        }
+        const Entry entry = itsQueue.front();
+        itsQueue.pop_front();
+        itsInFlight++;
+        pthread_mutex_unlock(&itsLock);
+
+        const Clock::time_point start = Clock::now();
+        write(entry, fptr, fileStart);
+        const double elapsed = seconds(start, Clock::now());
+
+        pthread_mutex_lock(&itsLock);
+        itsInFlight--;
+        itsWritten++;
+        itsWriteHist.record(elapsed);
+        itsFree.push_back(entry.buffer);
+        pthread_cond_broadcast(&itsChanged);
+    }
+    pthread_mutex_unlock(&itsLock);
+    if (fptr != NULL) {
+        fclose(fptr);
+    }
+}
+
+void IngestQueue::write(const Entry& entry, FILE*& fptr, int& fileStart)
+{
+    const int start = entry.integration - entry.integration % itsPerFile;
+    if (start != fileStart) {
+        if (fptr != NULL) {
+            fclose(fptr);
+        }
+        std::ostringstream oss;
+        oss << itsFilename << "_" << start << "_queued.dat";
+        fptr = fopen(oss.str().c_str(), "w");
+        assert(fptr);
+        fileStart = start;
+    }
+    const long offset = static_cast<long>(entry.integration % itsPerFile) * itsBytes;
+    if (fseek(fptr, offset, SEEK_SET) != 0
+            || fwrite(entry.buffer, itsBytes, 1, fptr) != 1
+            || fflush(fptr) != 0) {
+        std::cout << "WARNING - failed write: " << strerror(errno) << std::endl;
+    }
+}
+
+void IngestQueue::spill(const float* buffer, int integration)
+{
+    std::ostringstream oss;
+    oss << itsSpillDir << "/spill_" << integration << ".dat";
+    FILE* fptr = fopen(oss.str().c_str(), "w");
+    if (fptr == NULL || fwrite(buffer, itsBytes, 1, fptr) != 1) {
+        std::cout << "WARNING - failed to spill integration " << integration << ": "
+            << strerror(errno) << std::endl;
+    }
+    if (fptr != NULL) {
+        fclose(fptr);
+    }
+}
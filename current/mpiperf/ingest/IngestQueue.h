@@ -0,0 +1,138 @@
+/// @file IngestQueue.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef INGESTQUEUE_H
+#define INGESTQUEUE_H
+
+// System includes
+#include <string>
+#include <vector>
+#include <deque>
+#include <pthread.h>
+
+// Local includes
+#include "LatencyHistogram.h"
+
+/// Bounded queue of gathered integrations between the gather loop and a
+/// writer thread, for a real-time model of ingest. There are depth
+/// integration buffers. When all of them are queued or being written the
+/// policy decides what happens to the next integration:
+///
+/// - block: wait for the writer to free a buffer, stalling the correlator
+/// - drop-oldest: discard the oldest queued integration and reuse its buffer
+/// - drop-newest: receive the new integration into scratch and discard it
+/// - spill: receive it into scratch and write it to a local spill directory
+///   on the gather thread, to be recovered later
+///
+/// Integration i is written at offset (i % perFile) * bytes of file
+/// name_(first integration of the file)_queued.dat, so dropped integrations
+/// leave holes rather than shifting the rest.
+class IngestQueue
+{
+    public:
+        enum Policy { BLOCK, DROP_OLDEST, DROP_NEWEST, SPILL };
+
+        /// Parse a policy name, false if it is not one of the above
+        static bool parse(const std::string& name, Policy& policy);
+        static const char* name(Policy policy);
+
+        IngestQueue(size_t bytes, int depth, Policy policy, const std::string& filename,
+                int perFile, const std::string& spillDir, double deadline);
+
+        /// Waits for the queued integrations to be written
+        ~IngestQueue();
+
+        /// A buffer to receive the next integration into, applying the
+        /// policy if none is free
+        float* acquire(void);
+
+        /// Queue, drop or spill the integration received into the buffer
+        /// from the last acquire()
+        void submit(float* buffer, int integration);
+
+        /// Wait until all queued integrations have been written
+        void flush(void);
+
+        int depth(void) const { return itsBuffers.size(); }
+        Policy policy(void) const { return itsPolicy; }
+
+        /// Counters, read after flush()
+        unsigned long queued(void) const { return itsQueued; }
+        unsigned long written(void) const { return itsWritten; }
+        unsigned long dropped(void) const { return itsDropped; }
+        unsigned long spilled(void) const { return itsSpilled; }
+        unsigned long stalls(void) const { return itsStalls; }
+        double stallTime(void) const { return itsStallTime; }
+        double spillTime(void) const { return itsSpillTime; }
+        size_t highWater(void) const { return itsHighWater; }
+
+        /// Per-integration write times on the writer thread
+        const LatencyHistogram& writeLatency(void) const { return itsWriteHist; }
+
+    private:
+        // Not copyable
+        IngestQueue(const IngestQueue&);
+        IngestQueue& operator=(const IngestQueue&);
+
+        struct Entry {
+            float* buffer;
+            int integration;
+        };
+
+        static void* run(void* arg);
+        void writeLoop(void);
+        void write(const Entry& entry, FILE*& fptr, int& fileStart);
+        void spill(const float* buffer, int integration);
+
+        size_t itsBytes;
+        Policy itsPolicy;
+        std::string itsFilename;
+        int itsPerFile;
+        std::string itsSpillDir;
+        std::vector<float*> itsBuffers;
+        float* itsScratch;
+
+        pthread_t itsThread;
+        pthread_mutex_t itsLock;
+        pthread_cond_t itsChanged;
+
+        // Protected by itsLock
+        std::deque<float*> itsFree;
+        std::deque<Entry> itsQueue;
+        size_t itsInFlight;
+        bool itsStop;
+        unsigned long itsWritten;
+        size_t itsHighWater;
+        LatencyHistogram itsWriteHist;
+
+        // Only used by the gather thread
+        unsigned long itsQueued;
+        unsigned long itsDropped;
+        unsigned long itsSpilled;
+        unsigned long itsStalls;
+        double itsStallTime;
+        double itsSpillTime;
+};
+
+#endif
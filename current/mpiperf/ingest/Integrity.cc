@@ -0,0 +1,105 @@
+/// @file Integrity.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "Integrity.h"
+
+// System includes
+#include <algorithm>
+#include <chrono>
+
+// Local includes
+#include "Crc32c.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double since(const Clock::time_point& start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// SplitMix64, a counter-based generator, so any word of the payload can
+// be produced without the ones before it
+static inline uint64_t mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+Integrity::Integrity(size_t sliceBytes, size_t blockBytes, double deadline)
+: itsSliceBytes(sliceBytes), itsBlockBytes(blockBytes == 0 ? sliceBytes : blockBytes),
+    itsGenerate("Payload", deadline), itsChecksum("Checksum", deadline)
+{
+    itsBlocks = (itsSliceBytes + itsBlockBytes - 1) / itsBlockBytes;
+    itsSums.resize(itsBlocks);
+    itsFound.resize(itsBlocks);
+}
+
+void Integrity::generate(float* slice, int rank, int integration)
+{
+    Clock::time_point start = Clock::now();
+
+    // Visibility-like values: finite floats of magnitude [0.5, 1) with
+    // either sign, two to a word
+    const uint64_t seed = mix((static_cast<uint64_t>(rank) << 32) | static_cast<uint32_t>(integration));
+    const size_t n = itsSliceBytes / sizeof(float);
+    uint32_t* out = reinterpret_cast<uint32_t*>(slice);
+    for (size_t k = 0; k + 1 < n; k += 2) {
+        const uint64_t r = mix(seed + k);
+        out[k] = (static_cast<uint32_t>(r) & 0x807fffff) | 0x3f000000;
+        out[k + 1] = (static_cast<uint32_t>(r >> 32) & 0x807fffff) | 0x3f000000;
+    }
+    if (n % 2) {
+        out[n - 1] = (static_cast<uint32_t>(mix(seed + n - 1)) & 0x807fffff) | 0x3f000000;
+    }
+    itsGenerate.record(since(start));
+
+    start = Clock::now();
+    checksum(reinterpret_cast<const char*>(slice), &itsSums[0]);
+    itsChecksum.record(since(start));
+}
+
+void Integrity::checksum(const char* slice, uint32_t* sums) const
+{
+    for (size_t b = 0; b < itsBlocks; ++b) {
+        const size_t offset = b * itsBlockBytes;
+        const size_t bytes = std::min(itsBlockBytes, itsSliceBytes - offset);
+        sums[b] = crc32c(slice + offset, bytes);
+    }
+}
+
+unsigned long Integrity::verify(const char* data, size_t slices, const uint32_t* expected)
+{
+    unsigned long bad = 0;
+    for (size_t s = 0; s < slices; ++s) {
+        checksum(data + s * itsSliceBytes, &itsFound[0]);
+        for (size_t b = 0; b < itsBlocks; ++b) {
+            if (itsFound[b] != expected[s * itsBlocks + b]) {
+                ++bad;
+            }
+        }
+    }
+    return bad;
+}
@@ -0,0 +1,78 @@
+/// @file Integrity.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef INTEGRITY_H
+#define INTEGRITY_H
+
+// System includes
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+// Local includes
+#include "LatencyHistogram.h"
+
+/// End-to-end integrity of the gathered data. Each rank fills its slice
+/// with a synthetic payload that depends only on the rank, the integration
+/// and the position, and takes a CRC32C of every block of the slice. The
+/// writer checks the blocks it received, and can check them again when the
+/// file is read back, against the checksums the ranks sent.
+class Integrity
+{
+    public:
+        Integrity(size_t sliceBytes, size_t blockBytes, double deadline);
+
+        /// Blocks in one rank's slice, the last of which may be short
+        size_t blocks(void) const { return itsBlocks; }
+        size_t blockBytes(void) const { return itsBlockBytes; }
+
+        /// Fill a slice with the payload of this rank and integration, and
+        /// checksum its blocks into sums()
+        void generate(float* slice, int rank, int integration);
+
+        /// Checksums of the slice last generated
+        const uint32_t* sums(void) const { return &itsSums[0]; }
+
+        /// Checksum every block of a slice
+        void checksum(const char* slice, uint32_t* sums) const;
+
+        /// Check a run of consecutive slices against their expected
+        /// checksums, returning the number of blocks that differ
+        unsigned long verify(const char* data, size_t slices, const uint32_t* expected);
+
+        /// Time to generate the payload and to checksum it, per slice
+        const LatencyHistogram& generateTime(void) const { return itsGenerate; }
+        const LatencyHistogram& checksumTime(void) const { return itsChecksum; }
+
+    private:
+        size_t itsSliceBytes;
+        size_t itsBlockBytes;
+        size_t itsBlocks;
+        std::vector<uint32_t> itsSums;
+        std::vector<uint32_t> itsFound;
+        LatencyHistogram itsGenerate;
+        LatencyHistogram itsChecksum;
+};
+
+#endif
@@ -0,0 +1,250 @@
+/// @file Metrics.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "Metrics.h"
+
+// System includes
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// The calling thread's ring, and which Metrics it belongs to
+static thread_local void* threadOwner = 0;
+static thread_local void* threadRing = 0;
+
+Metrics::Metrics(const std::string& target, int rank, size_t capacity, int intervalMs)
+: itsRank(rank), itsCapacity(capacity), itsInterval(intervalMs > 0 ? intervalMs : 100),
+    itsFd(-1), itsDatagram(false), itsMaxDatagram(0), itsFailed(false), itsStop(false),
+    itsEvents(0), itsDropped(0)
+{
+    if (target.compare(0, 4, "udp:") == 0) {
+        // Keep each datagram within a typical MTU
+        const std::string hostPort = target.substr(4);
+        const size_t colon = hostPort.rfind(':');
+        const std::string host = hostPort.substr(0, colon);
+        const std::string port = colon == std::string::npos ? "8094" : hostPort.substr(colon + 1);
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_DGRAM;
+        struct addrinfo* addr = 0;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addr) == 0) {
+            itsFd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+            if (itsFd >= 0 && connect(itsFd, addr->ai_addr, addr->ai_addrlen) != 0) {
+                close(itsFd);
+                itsFd = -1;
+            }
+            freeaddrinfo(addr);
+        }
+        itsDatagram = true;
+        itsMaxDatagram = 1400;
+    } else if (target.compare(0, 5, "unix:") == 0) {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, target.c_str() + 5, sizeof(addr.sun_path) - 1);
+        itsFd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        if (itsFd >= 0 && connect(itsFd, (struct sockaddr*) &addr, sizeof(addr)) != 0) {
+            close(itsFd);
+            itsFd = -1;
+        }
+        itsDatagram = true;
+        itsMaxDatagram = 8192;
+    } else {
+        itsFd = open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    if (itsFd < 0) {
+        std::cout << "#WARNING - metrics not written to " << target << ": "
+            << strerror(errno) << std::endl;
+    }
+
+    pthread_mutex_init(&itsLock, 0);
+    pthread_cond_init(&itsChanged, 0);
+    if (pthread_create(&itsThread, 0, &Metrics::run, this) != 0) {
+        std::cout << "#WARNING - failed to start the metrics thread" << std::endl;
+        abort();
+    }
+}
+
+Metrics::~Metrics()
+{
+    pthread_mutex_lock(&itsLock);
+    itsStop = true;
+    pthread_cond_broadcast(&itsChanged);
+    pthread_mutex_unlock(&itsLock);
+    pthread_join(itsThread, 0);
+
+    pthread_cond_destroy(&itsChanged);
+    pthread_mutex_destroy(&itsLock);
+    if (itsFd >= 0) {
+        close(itsFd);
+    }
+    for (size_t i = 0; i < itsBuffers.size(); ++i) {
+        delete itsBuffers[i];
+    }
+    if (threadOwner == this) {
+        threadOwner = 0;
+        threadRing = 0;
+    }
+}
+
+long long Metrics::now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<long long>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+bool Metrics::push(Buffer& buffer, const char* tag, double seconds)
+{
+    Event event;
+    event.tag = tag;
+    event.seconds = seconds;
+    event.ns = now();
+    return buffer.push(event);
+}
+
+void Metrics::record(const char* tag, double seconds)
+{
+    if (push(*threadBuffer(), tag, seconds)) {
+        itsEvents.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        itsDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+double Metrics::calibrate(size_t n)
+{
+    Buffer scratch(n);
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < n; ++i) {
+        push(scratch, "calibrate,", 0.0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return n ? ((end.tv_sec - start.tv_sec) + 1e-9 * (end.tv_nsec - start.tv_nsec)) / n : 0.0;
+}
+
+Metrics::Buffer* Metrics::threadBuffer(void)
+{
+    if (threadOwner != this) {
+        Buffer* buffer = new Buffer(itsCapacity);
+        pthread_mutex_lock(&itsLock);
+        itsBuffers.push_back(buffer);
+        pthread_mutex_unlock(&itsLock);
+        threadOwner = this;
+        threadRing = buffer;
+    }
+    return static_cast<Buffer*>(threadRing);
+}
+
+void* Metrics::run(void* arg)
+{
+    static_cast<Metrics*>(arg)->flushLoop();
+    return 0;
+}
+
+void Metrics::flushLoop(void)
+{
+    pthread_mutex_lock(&itsLock);
+    while (!itsStop) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += (itsInterval % 1000) * 1000000L;
+        deadline.tv_sec += itsInterval / 1000 + deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+        pthread_cond_timedwait(&itsChanged, &itsLock, &deadline);
+        pthread_mutex_unlock(&itsLock);
+        drain();
+        pthread_mutex_lock(&itsLock);
+    }
+    pthread_mutex_unlock(&itsLock);
+    drain();
+}
+
+void Metrics::drain(void)
+{
+    pthread_mutex_lock(&itsLock);
+    const std::vector<Buffer*> buffers(itsBuffers);
+    pthread_mutex_unlock(&itsLock);
+
+    char line[256];
+    Event event;
+    itsLines.clear();
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        while (buffers[i]->pop(event)) {
+            const int n = snprintf(line, sizeof(line), "%srank=%d time_secs=%.9g %lld\n",
+                    event.tag, itsRank, event.seconds, event.ns);
+            if (n <= 0) {
+                continue;
+            }
+            const size_t size = std::min(static_cast<size_t>(n), sizeof(line) - 1);
+            if (itsDatagram && itsLines.size() + size > itsMaxDatagram) {
+                emit(itsLines.data(), itsLines.size());
+                itsLines.clear();
+            }
+            itsLines.append(line, size);
+        }
+    }
+    emit(itsLines.data(), itsLines.size());
+}
+
+void Metrics::emit(const char* data, size_t size)
+{
+    if (size == 0 || itsFd < 0) {
+        return;
+    }
+    ssize_t rtn;
+    if (itsDatagram) {
+        rtn = send(itsFd, data, size, 0);
+    } else {
+        size_t written = 0;
+        rtn = 0;
+        while (written < size) {
+            rtn = write(itsFd, data + written, size - written);
+            if (rtn < 0 && errno == EINTR) {
+                continue;
+            }
+            if (rtn <= 0) {
+                break;
+            }
+            written += rtn;
+        }
+    }
+    if (rtn < 0 && !itsFailed) {
+        // A collector that is not listening is not fatal, warn once
+        std::cout << "#WARNING - failed to write metrics: " << strerror(errno) << std::endl;
+        itsFailed = true;
+    }
+}
@@ -0,0 +1,110 @@
+/// @file Metrics.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef METRICS_H
+#define METRICS_H
+
+// System includes
+#include <string>
+#include <vector>
+#include <atomic>
+#include <pthread.h>
+
+// Local includes
+#include "SpscRing.h"
+
+/// Timed events in InfluxDB line protocol, recorded without I/O on the
+/// timed path. Each thread records into its own preallocated ring and a
+/// background thread drains the rings every interval, formats the lines
+///
+///     <tag>rank=<rank> time_secs=<seconds> <unix time in ns>
+///
+/// and writes them to a file, or sends them to a local collector (for
+/// example telegraf) over a datagram socket. An event recorded while its
+/// thread's ring is full is dropped and counted.
+class Metrics
+{
+    public:
+        /// The target is a file name, "udp:host:port" or "unix:/path".
+        /// Each thread's ring holds capacity events.
+        Metrics(const std::string& target, int rank, size_t capacity = 4096,
+                int intervalMs = 100);
+
+        /// Writes out the remaining events
+        ~Metrics();
+
+        /// Record an event from the calling thread. The tag is kept by
+        /// pointer, so must be a string literal, e.g. "mpi,action=gather,".
+        void record(const char* tag, double seconds);
+
+        /// Mean cost of record() in seconds, timed over n calls into a
+        /// scratch ring
+        double calibrate(size_t n = 100000);
+
+        unsigned long events(void) const { return itsEvents; }
+        unsigned long dropped(void) const { return itsDropped; }
+
+    private:
+        // Not copyable
+        Metrics(const Metrics&);
+        Metrics& operator=(const Metrics&);
+
+        struct Event {
+            const char* tag;
+            double seconds;
+            long long ns;
+        };
+        typedef SpscRing<Event> Buffer;
+
+        static long long now(void);
+        bool push(Buffer& buffer, const char* tag, double seconds);
+        Buffer* threadBuffer(void);
+
+        static void* run(void* arg);
+        void flushLoop(void);
+        void drain(void);
+        void emit(const char* data, size_t size);
+
+        int itsRank;
+        size_t itsCapacity;
+        int itsInterval;
+        int itsFd;
+        bool itsDatagram;
+        size_t itsMaxDatagram;
+        bool itsFailed;
+        std::string itsLines;
+
+        pthread_t itsThread;
+        pthread_mutex_t itsLock;
+        pthread_cond_t itsChanged;
+
+        // Protected by itsLock
+        std::vector<Buffer*> itsBuffers;
+        bool itsStop;
+
+        std::atomic<unsigned long> itsEvents;
+        std::atomic<unsigned long> itsDropped;
+};
+
+#endif
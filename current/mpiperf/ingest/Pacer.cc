@@ -0,0 +1,85 @@
+/// @file Pacer.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "Pacer.h"
+
+// System includes
+#include <algorithm>
+#include <cerrno>
+#include <time.h>
+
+Pacer::Pacer(double period)
+: itsPeriod(period), itsOrigin(now()), itsCount(0), itsWaiting(false), itsDrift(0.0),
+    itsLate(0), itsJitter("Start jitter", period)
+{
+}
+
+void Pacer::start(void)
+{
+    itsDrift = now() - (itsOrigin + itsCount * itsPeriod);
+    itsJitter.record(std::max(0.0, itsDrift));
+}
+
+double Pacer::next(void) const
+{
+    return itsOrigin + (itsCount + 1) * itsPeriod;
+}
+
+bool Pacer::wait(double slice)
+{
+    const double deadline = next();
+    const double t = now();
+    if (!itsWaiting && t > deadline) {
+        itsLate++;
+    }
+    itsWaiting = true;
+    sleepUntil(slice > 0.0 ? std::min(deadline, t + slice) : deadline);
+    if (now() < deadline) {
+        return false;
+    }
+    itsCount++;
+    itsWaiting = false;
+    return true;
+}
+
+double Pacer::now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+void Pacer::sleepUntil(double t)
+{
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(t);
+    ts.tv_nsec = static_cast<long>((t - ts.tv_sec) * 1e9);
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
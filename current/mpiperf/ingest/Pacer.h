@@ -0,0 +1,80 @@
+/// @file Pacer.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef PACER_H
+#define PACER_H
+
+// Local includes
+#include "LatencyHistogram.h"
+
+/// Paces a loop to the correlator cadence. Integration n is due at
+/// origin + n * period on the monotonic clock, and wait() sleeps to that
+/// absolute deadline with clock_nanosleep(TIMER_ABSTIME). Unlike a relative
+/// sleep, time lost waking up or overrunning one integration is not carried
+/// into the next.
+class Pacer
+{
+    public:
+        /// The schedule starts now
+        explicit Pacer(double period);
+
+        /// Call at the start of each integration to record how late it
+        /// started against the schedule
+        void start(void);
+
+        /// Sleep until the next integration is due, returning true once it
+        /// is. With a slice greater than zero, sleep at most that long and
+        /// return false if the integration is not yet due, so the caller
+        /// can do some work between calls.
+        bool wait(double slice = 0.0);
+
+        /// When the next integration is due, on the monotonic clock
+        double next(void) const;
+
+        /// Monotonic clock in seconds
+        static double now(void);
+
+        /// How late each integration started
+        const LatencyHistogram& jitter(void) const { return itsJitter; }
+
+        /// Lateness of the last integration's start, which would grow
+        /// steadily with drift
+        double drift(void) const { return itsDrift; }
+
+        /// Integrations still running when the next was due
+        unsigned long late(void) const { return itsLate; }
+
+    private:
+        static void sleepUntil(double t);
+
+        double itsPeriod;
+        double itsOrigin;
+        unsigned long itsCount;
+        bool itsWaiting;
+        double itsDrift;
+        unsigned long itsLate;
+        LatencyHistogram itsJitter;
+};
+
+#endif
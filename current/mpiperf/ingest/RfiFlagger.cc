@@ -0,0 +1,226 @@
+/// @file RfiFlagger.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "RfiFlagger.h"
+
+// System includes
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <pthread.h>
+
+const double RfiFlagger::rho = 1.5;
+
+// Passes of the clipped statistics, and the clip in sigma
+static const int passes = 3;
+static const float clip = 3.0f;
+
+RfiFlagger::RfiFlagger(size_t baselines, size_t channels, size_t series, int threads,
+        double threshold, size_t maxWindow)
+: itsBaselines(baselines), itsChannels(channels), itsSeries(std::max(static_cast<size_t>(1), series)),
+    itsThreads(std::max(1, threads)), itsThreshold(threshold),
+    itsMaxWindow(std::max(static_cast<size_t>(1), maxWindow))
+{
+}
+
+size_t RfiFlagger::flag(const float* data, uint64_t* flags, size_t nBlocks) const
+{
+    // Each task takes a run of baseline rows
+    const size_t nRows = nBlocks * itsBaselines;
+    const size_t nTasks = std::min(static_cast<size_t>(itsThreads), std::max(nRows,
+                static_cast<size_t>(1)));
+
+    std::vector<Task> tasks(nTasks);
+    for (size_t t = 0; t < nTasks; ++t) {
+        tasks[t].flagger = this;
+        tasks[t].data = data;
+        tasks[t].flags = flags;
+        tasks[t].first = nRows * t / nTasks;
+        tasks[t].last = nRows * (t + 1) / nTasks;
+        tasks[t].flagged = 0;
+    }
+
+    // The calling thread does the first share
+    std::vector<pthread_t> threads(nTasks);
+    std::vector<bool> started(nTasks, false);
+    for (size_t t = 1; t < nTasks; ++t) {
+        started[t] = pthread_create(&threads[t], 0, &RfiFlagger::run, &tasks[t]) == 0;
+    }
+    run(&tasks[0]);
+    size_t flagged = tasks[0].flagged;
+    for (size_t t = 1; t < nTasks; ++t) {
+        if (started[t]) {
+            pthread_join(threads[t], 0);
+        } else {
+            run(&tasks[t]);
+        }
+        flagged += tasks[t].flagged;
+    }
+    return flagged;
+}
+
+void* RfiFlagger::run(void* arg)
+{
+    Task* task = static_cast<Task*>(arg);
+    task->flagged = task->flagger->flagRows(task->data, task->flags, task->first, task->last);
+    return 0;
+}
+
+size_t RfiFlagger::flagRows(const float* data, uint64_t* flags, size_t first, size_t last) const
+{
+    const size_t nS = itsSeries;
+    const size_t nC = itsChannels;
+    const size_t n = nC * nS;
+
+    // Work space for one row, [chan][series]. The mask is kept as 0 or 1
+    // in floats so the window sums blend flagged samples without a branch.
+    std::vector<float> amp(n);
+    std::vector<float> mask(n);
+    std::vector<unsigned char> hit(n);
+    std::vector<float> level(nS);
+    std::vector<float> spread(nS);
+    std::vector<float> sum(nS);
+    std::vector<float> sumSq(nS);
+    std::vector<float> weight(nS);
+    std::vector<int> countdown(nS);
+
+    size_t flagged = 0;
+    for (size_t row = first; row < last; ++row) {
+        const float* __restrict__ vis = data + row * n * 2;
+        float* __restrict__ a = &amp[0];
+        float* __restrict__ m = &mask[0];
+        unsigned char* __restrict__ h = &hit[0];
+
+        for (size_t i = 0; i < n; ++i) {
+            const float re = vis[2 * i];
+            const float im = vis[2 * i + 1];
+            a[i] = std::sqrt(re * re + im * im);
+            m[i] = 0.0f;
+        }
+
+        // Level and spread of each series: the mean and standard deviation,
+        // clipped at clip sigma and recomputed so strong RFI does not bias
+        // them. Each pass runs over contiguous series and vectorises.
+        float* __restrict__ lv = &level[0];
+        float* __restrict__ sp = &spread[0];
+        float* __restrict__ s1 = &sum[0];
+        float* __restrict__ s2 = &sumSq[0];
+        float* __restrict__ nn = &weight[0];
+        for (int pass = 0; pass < passes; ++pass) {
+            for (size_t s = 0; s < nS; ++s) {
+                s1[s] = 0.0f;
+                s2[s] = 0.0f;
+                nn[s] = 0.0f;
+            }
+            for (size_t c = 0; c < nC; ++c) {
+                const float* __restrict__ ac = a + c * nS;
+                for (size_t s = 0; s < nS; ++s) {
+                    const float keep = (pass == 0 ||
+                            std::fabs(ac[s] - lv[s]) <= clip * sp[s]) ? 1.0f : 0.0f;
+                    s1[s] += keep * ac[s];
+                    s2[s] += keep * ac[s] * ac[s];
+                    nn[s] += keep;
+                }
+            }
+            for (size_t s = 0; s < nS; ++s) {
+                const float count = std::max(nn[s], 1.0f);
+                lv[s] = s1[s] / count;
+                sp[s] = std::sqrt(std::max(s2[s] / count - lv[s] * lv[s], 0.0f));
+            }
+        }
+        for (size_t s = 0; s < nS; ++s) {
+            sp[s] = (sp[s] > 0.0f) ? 1.0f / sp[s] : 0.0f;
+        }
+        for (size_t c = 0; c < nC; ++c) {
+            float* __restrict__ ac = a + c * nS;
+            for (size_t s = 0; s < nS; ++s) {
+                ac[s] = (ac[s] - lv[s]) * sp[s];
+            }
+        }
+
+        float* __restrict__ sm = &sum[0];
+        int* __restrict__ cd = &countdown[0];
+        float threshold = static_cast<float>(itsThreshold);
+        for (size_t window = 1; window <= itsMaxWindow && window <= nC;
+                window *= 2, threshold /= static_cast<float>(rho)) {
+            const float limit = threshold * window;
+
+            // Sliding sums over the window, flagged samples counting at the
+            // threshold; h marks each window end that exceeds the limit
+            for (size_t s = 0; s < nS; ++s) {
+                sm[s] = 0.0f;
+            }
+            for (size_t c = 0; c < nC; ++c) {
+                const float* __restrict__ ac = a + c * nS;
+                const float* __restrict__ mc = m + c * nS;
+                unsigned char* __restrict__ hc = h + c * nS;
+                for (size_t s = 0; s < nS; ++s) {
+                    sm[s] += ac[s] + mc[s] * (threshold - ac[s]);
+                }
+                if (c >= window) {
+                    const float* __restrict__ ao = a + (c - window) * nS;
+                    const float* __restrict__ mo = m + (c - window) * nS;
+                    for (size_t s = 0; s < nS; ++s) {
+                        sm[s] -= ao[s] + mo[s] * (threshold - ao[s]);
+                    }
+                }
+                const bool full = (c + 1 >= window);
+                for (size_t s = 0; s < nS; ++s) {
+                    hc[s] = full && sm[s] > limit;
+                }
+            }
+
+            // Spread each hit back over its window, then add to the mask
+            for (size_t s = 0; s < nS; ++s) {
+                cd[s] = 0;
+            }
+            const int w = static_cast<int>(window);
+            for (size_t c = nC; c-- > 0; ) {
+                unsigned char* __restrict__ hc = h + c * nS;
+                float* __restrict__ mc = m + c * nS;
+                for (size_t s = 0; s < nS; ++s) {
+                    cd[s] = hc[s] ? w : cd[s];
+                    const int on = cd[s] > 0;
+                    cd[s] -= on;
+                    mc[s] = std::max(mc[s], static_cast<float>(on));
+                }
+            }
+        }
+
+        // Pack the row's mask, a bit per sample
+        uint64_t* out = flags + row * rowWords();
+        for (size_t word = 0; word < rowWords(); ++word) {
+            const size_t base = word * 64;
+            const size_t count = std::min(static_cast<size_t>(64), n - base);
+            uint64_t bits = 0;
+            for (size_t k = 0; k < count; ++k) {
+                bits |= static_cast<uint64_t>(m[base + k] != 0.0f) << k;
+            }
+            out[word] = bits;
+            flagged += __builtin_popcountll(bits);
+        }
+    }
+    return flagged;
+}
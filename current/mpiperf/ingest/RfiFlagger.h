@@ -0,0 +1,92 @@
+/// @file RfiFlagger.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef RFIFLAGGER_H
+#define RFIFLAGGER_H
+
+// System includes
+#include <cstddef>
+#include <stdint.h>
+
+/// SumThreshold RFI flagger (Offringa et al. 2010) for gathered
+/// visibilities in [block][baseline][chan][beam][pol] order. The amplitude
+/// spectrum of each baseline, beam and pol is normalised by its mean and
+/// standard deviation, sigma-clipped so the RFI does not inflate them. Then
+/// windows of 1, 2, 4, ... channels are flagged where their mean exceeds a
+/// threshold that falls by a factor rho with each doubling, with samples
+/// already flagged counting at the threshold.
+///
+/// The beam x pol spectra of a baseline are processed side by side, so the
+/// inner loops run over contiguous series and vectorise, and the baselines
+/// are shared out between threads. Flags are one bit per complex sample in
+/// the data order, each baseline's row starting on a 64-bit word.
+class RfiFlagger
+{
+    public:
+        /// Series is the number of complex samples per channel (beams x
+        /// pols); threshold is the single-channel threshold in sigma
+        RfiFlagger(size_t baselines, size_t channels, size_t series, int threads = 1,
+                double threshold = 6.0, size_t maxWindow = 32);
+
+        /// Flag nBlocks blocks of data into flags, which must hold
+        /// flagWords(nBlocks) words. Returns the number of samples flagged.
+        size_t flag(const float* data, uint64_t* flags, size_t nBlocks) const;
+
+        /// Words of flags for nBlocks blocks
+        size_t flagWords(size_t nBlocks) const { return nBlocks * itsBaselines * rowWords(); }
+
+        /// Complex samples in nBlocks blocks
+        size_t samples(size_t nBlocks) const { return nBlocks * itsBaselines * itsChannels * itsSeries; }
+
+        int threads(void) const { return itsThreads; }
+
+        /// Threshold drop per doubling of the window
+        static const double rho;
+
+    private:
+        struct Task {
+            const RfiFlagger* flagger;
+            const float* data;
+            uint64_t* flags;
+            size_t first;
+            size_t last;
+            size_t flagged;
+        };
+
+        static void* run(void* arg);
+
+        // Flag baseline rows [first, last), counted over all blocks
+        size_t flagRows(const float* data, uint64_t* flags, size_t first, size_t last) const;
+
+        size_t rowWords(void) const { return (itsChannels * itsSeries + 63) / 64; }
+
+        size_t itsBaselines;
+        size_t itsChannels;
+        size_t itsSeries;
+        int itsThreads;
+        double itsThreshold;
+        size_t itsMaxWindow;
+};
+
+#endif
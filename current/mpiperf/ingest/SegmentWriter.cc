@@ -0,0 +1,180 @@
+/// @file SegmentWriter.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "SegmentWriter.h"
+
+// System includes
+#include <iostream>
+#include <cstdlib>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+#include <unistd.h>
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds(const Clock::time_point& start, const Clock::time_point& end)
+{
+    return std::chrono::duration<double>(end - start).count();
+}
+
+SegmentWriter::SegmentWriter(size_t bufferBytes, int nBuffers)
+: itsBufferBytes(bufferBytes), itsInFlight(0), itsStop(false), itsWriteTime(0.0),
+    itsStalls(0), itsStallTime(0.0)
+{
+    if (nBuffers < 1) {
+        nBuffers = 1;
+    }
+    for (int i = 0; i < nBuffers; ++i) {
+        itsBuffers.push_back((float *) malloc(bufferBytes));
+        assert(itsBuffers.back());
+        itsFree.push_back(itsBuffers.back());
+    }
+
+    pthread_mutex_init(&itsLock, 0);
+    pthread_cond_init(&itsChanged, 0);
+    if (pthread_create(&itsThread, 0, &SegmentWriter::run, this) != 0) {
+        std::cout << "WARNING - failed to start the writer thread" << std::endl;
+        abort();
+    }
+}
+
+SegmentWriter::~SegmentWriter()
+{
+    pthread_mutex_lock(&itsLock);
+    itsStop = true;
+    pthread_cond_broadcast(&itsChanged);
+    pthread_mutex_unlock(&itsLock);
+    pthread_join(itsThread, 0);
+
+    pthread_cond_destroy(&itsChanged);
+    pthread_mutex_destroy(&itsLock);
+
+    for (size_t i = 0; i < itsBuffers.size(); ++i) {
+        free(itsBuffers[i]);
+    }
+}
+
+float* SegmentWriter::acquire(void)
+{
+    const Clock::time_point start = Clock::now();
+    pthread_mutex_lock(&itsLock);
+    const bool stalled = itsFree.empty();
+    while (itsFree.empty()) {
+        pthread_cond_wait(&itsChanged, &itsLock);
+    }
+    float* buffer = itsFree.front();
+    itsFree.pop_front();
+    pthread_mutex_unlock(&itsLock);
+
+    if (stalled) {
+        itsStalls++;
+        itsStallTime += seconds(start, Clock::now());
+    }
+    return buffer;
+}
+
+void SegmentWriter::submit(const Segment& segment)
+{
+    pthread_mutex_lock(&itsLock);
+    itsQueue.push_back(segment);
+    pthread_cond_broadcast(&itsChanged);
+    pthread_mutex_unlock(&itsLock);
+}
+
+void SegmentWriter::flush(void)
+{
+    pthread_mutex_lock(&itsLock);
+    while (!itsQueue.empty() || itsInFlight > 0) {
+        pthread_cond_wait(&itsChanged, &itsLock);
+    }
+    pthread_mutex_unlock(&itsLock);
+}
+
+double SegmentWriter::writeTime(void) const
+{
+    pthread_mutex_lock(&itsLock);
+    const double t = itsWriteTime;
+    pthread_mutex_unlock(&itsLock);
+    return t;
+}
+
+void* SegmentWriter::run(void* arg)
+{
+    static_cast<SegmentWriter*>(arg)->writeLoop();
+    return 0;
+}
+
+void SegmentWriter::writeLoop(void)
+{
+    pthread_mutex_lock(&itsLock);
+    for (;;) {
+        while (itsQueue.empty() && !itsStop) {
+            pthread_cond_wait(&itsChanged, &itsLock);
+        }
+        if (itsQueue.empty()) {
+            break;
+        }
+        const Segment segment = itsQueue.front();
+        itsQueue.pop_front();
+        itsInFlight++;
+        pthread_mutex_unlock(&itsLock);
+
+        const Clock::time_point start = Clock::now();
+        write(segment);
+        const double elapsed = seconds(start, Clock::now());
+
+        pthread_mutex_lock(&itsLock);
+        itsInFlight--;
+        itsWriteTime += elapsed;
+        itsFree.push_back(segment.data);
+        pthread_cond_broadcast(&itsChanged);
+    }
+    pthread_mutex_unlock(&itsLock);
+}
+
+void SegmentWriter::write(const Segment& segment)
+{
+    const char* data = (const char *) segment.data;
+    for (int p = 0; p < segment.nPieces; ++p) {
+        const char* piece = data + p * segment.pieceBytes;
+        off_t offset = segment.offset + p * segment.stride;
+        size_t towrite = segment.pieceBytes;
+        while (towrite > 0) {
+            const ssize_t rtn = pwrite(segment.fd, piece, towrite, offset);
+            if (rtn < 0 && errno == EINTR) {
+                continue;
+            }
+            if (rtn <= 0) {
+                std::cout << "WARNING - failed write: " << strerror(errno) << std::endl;
+                return;
+            }
+            piece += rtn;
+            offset += rtn;
+            towrite -= rtn;
+        }
+    }
+}
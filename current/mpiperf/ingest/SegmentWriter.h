@@ -0,0 +1,109 @@
+/// @file SegmentWriter.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef SEGMENTWRITER_H
+#define SEGMENTWRITER_H
+
+// System includes
+#include <vector>
+#include <deque>
+#include <sys/types.h>
+#include <pthread.h>
+
+/// Writes gathered segments of an integration on a dedicated thread, so the
+/// next segment can be received while the previous one is written.
+///
+/// A segment holds the same channel block from every rank, one piece per
+/// rank. The pieces are written at offset, offset + stride, ... so the file
+/// layout matches a gather of the whole integration.
+struct Segment {
+    float* data;
+    int fd;
+    off_t offset;
+    off_t stride;
+    size_t pieceBytes;
+    int nPieces;
+};
+
+/// There are nBuffers segment buffers of bufferBytes each. The caller takes
+/// a free buffer with acquire(), receives into it and queues it with
+/// submit(). When every buffer is queued or being written acquire() blocks;
+/// that time is counted as a stall.
+class SegmentWriter
+{
+    public:
+        SegmentWriter(size_t bufferBytes, int nBuffers);
+
+        /// Waits for the queued segments to be written
+        ~SegmentWriter();
+
+        /// Next free buffer, blocking until the writer releases one
+        float* acquire(void);
+
+        /// Queue a segment whose data came from acquire() for writing
+        void submit(const Segment& segment);
+
+        /// Wait until all queued segments have been written
+        void flush(void);
+
+        /// Number of buffers and the size of each in bytes
+        size_t depth(void) const { return itsBuffers.size(); }
+        size_t bufferBytes(void) const { return itsBufferBytes; }
+
+        /// Number of acquire() calls that blocked, and the total time
+        unsigned long stalls(void) const { return itsStalls; }
+        double stallTime(void) const { return itsStallTime; }
+
+        /// Total time spent writing, in seconds
+        double writeTime(void) const;
+
+    private:
+        // Not copyable
+        SegmentWriter(const SegmentWriter&);
+        SegmentWriter& operator=(const SegmentWriter&);
+
+        static void* run(void* arg);
+        void writeLoop(void);
+        static void write(const Segment& segment);
+
+        size_t itsBufferBytes;
+        std::vector<float*> itsBuffers;
+
+        pthread_t itsThread;
+        mutable pthread_mutex_t itsLock;
+        pthread_cond_t itsChanged;
+
+        // Protected by itsLock
+        std::deque<float*> itsFree;
+        std::deque<Segment> itsQueue;
+        size_t itsInFlight;
+        bool itsStop;
+        double itsWriteTime;
+
+        // Only used by the caller's thread
+        unsigned long itsStalls;
+        double itsStallTime;
+};
+
+#endif
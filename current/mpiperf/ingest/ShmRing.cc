@@ -0,0 +1,163 @@
+/// @file ShmRing.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "ShmRing.h"
+
+// System includes
+#include <iostream>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/// Control words of one slot, a cache line each so producers depositing
+/// into one slot do not contend with the writer releasing another
+struct ShmRing::Control {
+    int generation;     // integration the slot is free for
+    int deposited;      // producers done with that integration
+    char pad[64 - 2 * sizeof(int)];
+};
+
+static const size_t pageBytes = 4096;
+
+// Shared (not private) futex operations, as the words are in a segment
+// mapped by several processes
+static void futexWait(int* word, int expected)
+{
+    syscall(SYS_futex, word, FUTEX_WAIT, expected, NULL, NULL, 0);
+}
+
+static void futexWake(int* word)
+{
+    syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+ShmRing::ShmRing(const std::string& name, size_t slotBytes, int depth, int producers,
+        bool owner)
+: itsName(name), itsSlotBytes(slotBytes), itsDepth(depth < 1 ? 1 : depth),
+    itsProducers(producers), itsOwner(owner), itsBase(0), itsWaits(0)
+{
+    itsHeaderBytes = (itsDepth * sizeof(Control) + pageBytes - 1) / pageBytes * pageBytes;
+    itsStride = (itsSlotBytes + pageBytes - 1) / pageBytes * pageBytes;
+    itsMapBytes = itsHeaderBytes + itsDepth * itsStride;
+
+    const int fd = shm_open(itsName.c_str(), owner ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR, 0600);
+    if (fd < 0) {
+        std::cout << "WARNING - failed to open shared memory " << itsName << " (errno "
+            << errno << ")" << std::endl;
+        return;
+    }
+    if (owner && ftruncate(fd, itsMapBytes) != 0) {
+        std::cout << "WARNING - failed to size shared memory " << itsName << std::endl;
+        ::close(fd);
+        shm_unlink(itsName.c_str());
+        return;
+    }
+    // Populated up front so the first integration does not pay the page faults
+    void* p = mmap(NULL, itsMapBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::cout << "WARNING - failed to map shared memory " << itsName << std::endl;
+        if (owner) {
+            shm_unlink(itsName.c_str());
+        }
+        return;
+    }
+    itsBase = static_cast<char*>(p);
+
+    // A new segment is zeroed, so only the generations need setting
+    if (owner) {
+        for (int s = 0; s < itsDepth; ++s) {
+            __atomic_store_n(&control(s)->generation, s, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+ShmRing::~ShmRing()
+{
+    if (itsBase != 0) {
+        munmap(itsBase, itsMapBytes);
+    }
+    unlink();
+}
+
+void ShmRing::unlink(void)
+{
+    if (itsOwner && !itsName.empty()) {
+        shm_unlink(itsName.c_str());
+        itsName.clear();
+    }
+}
+
+ShmRing::Control* ShmRing::control(int i) const
+{
+    return reinterpret_cast<Control*>(itsBase) + (i % itsDepth);
+}
+
+char* ShmRing::slot(int i) const
+{
+    return itsBase + itsHeaderBytes + (i % itsDepth) * itsStride;
+}
+
+char* ShmRing::claim(int i)
+{
+    Control* c = control(i);
+    int g;
+    while ((g = __atomic_load_n(&c->generation, __ATOMIC_ACQUIRE)) != i) {
+        ++itsWaits;
+        futexWait(&c->generation, g);
+    }
+    return slot(i);
+}
+
+void ShmRing::deposit(int i)
+{
+    Control* c = control(i);
+    if (__atomic_add_fetch(&c->deposited, 1, __ATOMIC_ACQ_REL) == itsProducers) {
+        futexWake(&c->deposited);
+    }
+}
+
+char* ShmRing::collect(int i)
+{
+    Control* c = control(i);
+    int d;
+    while ((d = __atomic_load_n(&c->deposited, __ATOMIC_ACQUIRE)) < itsProducers) {
+        ++itsWaits;
+        futexWait(&c->deposited, d);
+    }
+    return slot(i);
+}
+
+void ShmRing::release(int i)
+{
+    Control* c = control(i);
+    __atomic_store_n(&c->deposited, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&c->generation, i + itsDepth, __ATOMIC_RELEASE);
+    futexWake(&c->generation);
+}
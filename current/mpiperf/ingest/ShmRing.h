@@ -0,0 +1,96 @@
+/// @file ShmRing.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef SHMRING_H
+#define SHMRING_H
+
+// System includes
+#include <string>
+#include <cstddef>
+
+/// A ring of integration buffers in POSIX shared memory, through which the
+/// ranks on the writer's node hand over their data without the MPI stack.
+/// Slot i % depth holds integration i. Each producer claims the slot, copies
+/// its own slice into it and deposits it; the writer waits until every
+/// producer has deposited, writes the slot and releases it for integration
+/// i + depth. Waits sleep on a futex in the shared segment, so neither side
+/// spins while the other is busy.
+class ShmRing
+{
+    public:
+        /// The owner creates the segment called name; the other ranks on
+        /// the node attach to it once it exists. Producers is the number of
+        /// ranks depositing into each slot.
+        ShmRing(const std::string& name, size_t slotBytes, int depth, int producers,
+                bool owner);
+
+        ~ShmRing();
+
+        /// Whether the segment was created or attached
+        bool ok(void) const { return itsBase != 0; }
+
+        /// Remove the segment's name; the mappings stay valid. The owner
+        /// calls this once every rank has attached.
+        void unlink(void);
+
+        /// Producer: wait until the slot for integration i is free and
+        /// return it
+        char* claim(int i);
+
+        /// Producer: this rank's part of integration i is in place
+        void deposit(int i);
+
+        /// Writer: wait until every producer has deposited integration i
+        /// and return its slot
+        char* collect(int i);
+
+        /// Writer: the slot of integration i has been written and is free
+        /// for integration i + depth
+        void release(int i);
+
+        int depth(void) const { return itsDepth; }
+        size_t slotBytes(void) const { return itsSlotBytes; }
+
+        /// Times this rank went to sleep waiting on the other side
+        unsigned long waits(void) const { return itsWaits; }
+
+    private:
+        struct Control;
+
+        Control* control(int i) const;
+        char* slot(int i) const;
+
+        std::string itsName;
+        size_t itsSlotBytes;
+        int itsDepth;
+        int itsProducers;
+        bool itsOwner;
+        size_t itsHeaderBytes;
+        size_t itsStride;
+        size_t itsMapBytes;
+        char* itsBase;
+        unsigned long itsWaits;
+};
+
+#endif
@@ -0,0 +1,125 @@
+/// @file SpscRing.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+// System includes
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <sched.h>
+#include <time.h>
+
+/// Lock-free ring for one producer thread and one consumer thread. The
+/// producer only writes the tail and the consumer only the head, each
+/// published with release and read with acquire, so whatever the producer
+/// wrote before a push is visible to the consumer after the matching pop.
+/// The capacity is rounded up to a power of two.
+template <typename T>
+class SpscRing
+{
+    public:
+        explicit SpscRing(size_t capacity)
+            : itsHead(0), itsTail(0)
+        {
+            size_t size = 1;
+            while (size < capacity) {
+                size <<= 1;
+            }
+            itsSlots.resize(size);
+            itsMask = size - 1;
+        }
+
+        /// Add a value, false if the ring is full. Producer only.
+        bool push(const T& value)
+        {
+            const size_t tail = itsTail.load(std::memory_order_relaxed);
+            if (tail - itsHead.load(std::memory_order_acquire) > itsMask) {
+                return false;
+            }
+            itsSlots[tail & itsMask] = value;
+            itsTail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// Take the oldest value, false if the ring is empty. Consumer only.
+        bool pop(T& value)
+        {
+            const size_t head = itsHead.load(std::memory_order_relaxed);
+            if (head == itsTail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            value = itsSlots[head & itsMask];
+            itsHead.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// As push() and pop(), waiting while the ring is full or empty
+        void pushWait(const T& value)
+        {
+            for (unsigned n = 0; !push(value); ++n) {
+                backoff(n);
+            }
+        }
+
+        T popWait(void)
+        {
+            T value;
+            for (unsigned n = 0; !pop(value); ++n) {
+                backoff(n);
+            }
+            return value;
+        }
+
+        size_t capacity(void) const { return itsSlots.size(); }
+
+    private:
+        // Spin briefly, then yield, then sleep 50us at a time, so a handoff
+        // is seen quickly without burning a core through a long wait
+        static void backoff(unsigned n)
+        {
+            if (n < 100) {
+                return;
+            }
+            if (n < 1000) {
+                sched_yield();
+                return;
+            }
+            const struct timespec ts = { 0, 50000 };
+            nanosleep(&ts, NULL);
+        }
+
+        std::vector<T> itsSlots;
+        size_t itsMask;
+
+        // Padded onto separate cache lines so the two threads do not
+        // contend. Padding rather than alignas, which operator new need not
+        // honour before C++17.
+        std::atomic<size_t> itsHead;
+        char itsPad[64];
+        std::atomic<size_t> itsTail;
+};
+
+#endif
@@ -0,0 +1,229 @@
+/// @file StripedWriter.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "StripedWriter.h"
+
+// System includes
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+
+typedef std::chrono::steady_clock Clock;
+
+StripedWriter::StripedWriter(int streams, size_t blockSize, bool direct, bool separate)
+: itsBlockSize(blockSize), itsDirect(direct), itsSeparate(separate),
+    itsGeneration(0), itsPending(0), itsStop(false), itsData(0), itsSize(0), itsBase(0)
+{
+    if (itsDirect && itsBlockSize % alignment != 0) {
+        itsBlockSize = (itsBlockSize / alignment + 1) * alignment;
+        std::cout << "WARNING - stripe block size rounded up to " << itsBlockSize
+            << " bytes for O_DIRECT" << std::endl;
+    }
+    if (itsBlockSize == 0) {
+        itsBlockSize = alignment;
+    }
+
+    itsStreams.resize(std::max(1, streams));
+    pthread_mutex_init(&itsLock, 0);
+    pthread_cond_init(&itsStart, 0);
+    pthread_cond_init(&itsDone, 0);
+    for (size_t s = 0; s < itsStreams.size(); ++s) {
+        Stream& stream = itsStreams[s];
+        stream.owner = this;
+        stream.index = s;
+        stream.fd = -1;
+        stream.offset = 0;
+        stream.end = 0;
+        stream.bytes = 0.0;
+        stream.seconds = 0.0;
+    }
+    for (size_t s = 0; s < itsStreams.size(); ++s) {
+        if (pthread_create(&itsStreams[s].thread, 0, &StripedWriter::run, &itsStreams[s]) != 0) {
+            std::cout << "WARNING - failed to start a stripe thread" << std::endl;
+            abort();
+        }
+    }
+}
+
+StripedWriter::~StripedWriter()
+{
+    close();
+    pthread_mutex_lock(&itsLock);
+    itsStop = true;
+    pthread_cond_broadcast(&itsStart);
+    pthread_mutex_unlock(&itsLock);
+    for (size_t s = 0; s < itsStreams.size(); ++s) {
+        pthread_join(itsStreams[s].thread, 0);
+    }
+    pthread_cond_destroy(&itsDone);
+    pthread_cond_destroy(&itsStart);
+    pthread_mutex_destroy(&itsLock);
+}
+
+void StripedWriter::open(const std::string& name)
+{
+    close();
+    for (size_t s = 0; s < itsStreams.size(); ++s) {
+        std::ostringstream oss;
+        oss << name;
+        if (itsSeparate) {
+            oss << "_" << s;
+        }
+        oss << ".dat";
+
+        // Only the first stream truncates a shared file
+        int flags = O_WRONLY | O_CREAT;
+        if (itsSeparate || s == 0) {
+            flags |= O_TRUNC;
+        }
+        int fd = ::open(oss.str().c_str(), flags | (itsDirect ? O_DIRECT : 0), 0644);
+        if (fd < 0 && itsDirect && errno == EINVAL) {
+            std::cout << "WARNING - O_DIRECT not supported for " << oss.str()
+                << ", writing through the page cache" << std::endl;
+            itsDirect = false;
+            fd = ::open(oss.str().c_str(), flags, 0644);
+        }
+        if (fd < 0) {
+            std::cout << "WARNING - failed to open " << oss.str() << ": "
+                << strerror(errno) << std::endl;
+        }
+        itsStreams[s].fd = fd;
+        itsStreams[s].offset = 0;
+        itsStreams[s].end = 0;
+    }
+}
+
+void StripedWriter::close(void)
+{
+    // O_DIRECT writes of a partial block went past the real end
+    off_t sharedEnd = 0;
+    for (size_t s = 0; s < itsStreams.size(); ++s) {
+        sharedEnd = std::max(sharedEnd, itsStreams[s].end);
+    }
+    for (size_t s = 0; s < itsStreams.size(); ++s) {
+        Stream& stream = itsStreams[s];
+        if (stream.fd < 0) {
+            continue;
+        }
+        if (itsDirect && (itsSeparate || s == 0)) {
+            if (ftruncate(stream.fd, itsSeparate ? stream.end : sharedEnd) != 0) {
+                std::cout << "WARNING - failed to trim padding: " << strerror(errno) << std::endl;
+            }
+        }
+        ::close(stream.fd);
+        stream.fd = -1;
+    }
+}
+
+void StripedWriter::write(const char* data, size_t size, off_t base)
+{
+    pthread_mutex_lock(&itsLock);
+    itsData = data;
+    itsSize = size;
+    itsBase = base;
+    itsPending = itsStreams.size();
+    itsGeneration++;
+    pthread_cond_broadcast(&itsStart);
+    while (itsPending > 0) {
+        pthread_cond_wait(&itsDone, &itsLock);
+    }
+    pthread_mutex_unlock(&itsLock);
+}
+
+void* StripedWriter::run(void* arg)
+{
+    Stream* stream = static_cast<Stream*>(arg);
+    stream->owner->streamLoop(*stream);
+    return 0;
+}
+
+void StripedWriter::streamLoop(Stream& stream)
+{
+    unsigned long seen = 0;
+    pthread_mutex_lock(&itsLock);
+    for (;;) {
+        while (itsGeneration == seen && !itsStop) {
+            pthread_cond_wait(&itsStart, &itsLock);
+        }
+        if (itsStop) {
+            break;
+        }
+        seen = itsGeneration;
+        pthread_mutex_unlock(&itsLock);
+
+        const Clock::time_point start = Clock::now();
+        writeBlocks(stream);
+        stream.seconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+        pthread_mutex_lock(&itsLock);
+        if (--itsPending == 0) {
+            pthread_cond_signal(&itsDone);
+        }
+    }
+    pthread_mutex_unlock(&itsLock);
+}
+
+void StripedWriter::writeBlocks(Stream& stream)
+{
+    if (stream.fd < 0) {
+        return;
+    }
+    const size_t nStreams = itsStreams.size();
+    for (size_t first = stream.index * itsBlockSize; first < itsSize;
+            first += nStreams * itsBlockSize) {
+        const size_t length = std::min(itsBlockSize, itsSize - first);
+        size_t towrite = length;
+        if (itsDirect && towrite % alignment != 0) {
+            towrite = (towrite / alignment + 1) * alignment;
+        }
+        off_t offset = itsSeparate ? stream.offset : itsBase + static_cast<off_t>(first);
+        const off_t end = offset + length;
+        const char* block = itsData + first;
+        while (towrite > 0) {
+            const ssize_t rtn = pwrite(stream.fd, block, towrite, offset);
+            if (rtn < 0 && errno == EINTR) {
+                continue;
+            }
+            if (rtn <= 0) {
+                std::cout << "WARNING - failed write: " << strerror(errno) << std::endl;
+                return;
+            }
+            block += rtn;
+            offset += rtn;
+            towrite -= rtn;
+        }
+        if (itsSeparate) {
+            stream.offset = offset;
+        }
+        stream.end = std::max(stream.end, end);
+        stream.bytes += length;
+    }
+}
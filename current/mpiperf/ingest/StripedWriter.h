@@ -0,0 +1,113 @@
+/// @file StripedWriter.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef STRIPEDWRITER_H
+#define STRIPEDWRITER_H
+
+// System includes
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <pthread.h>
+
+/// Writes each integration through a pool of streams, one thread each, so
+/// a parallel filesystem sees several writes in flight rather than one.
+///
+/// The integration is cut into blocks dealt out to the streams round robin.
+/// The streams either write their blocks in place in one shared file, which
+/// ends up the same as a single sequential write, or append them to a file
+/// per stream. With O_DIRECT the data, the offsets and the block size must
+/// be multiples of alignment, and a partial last block is written padded
+/// to it from the caller's buffer.
+class StripedWriter
+{
+    public:
+        static const size_t alignment = 4096;
+
+        StripedWriter(int streams, size_t blockSize, bool direct, bool separate);
+
+        /// Closes the output and stops the stream threads
+        ~StripedWriter();
+
+        /// Create (or truncate) the output: name.dat, or name_s.dat for
+        /// each stream s when the files are separate
+        void open(const std::string& name);
+
+        /// Trim any O_DIRECT padding and close the output
+        void close(void);
+
+        /// Write size bytes, placed at base in a shared file. Returns once
+        /// every stream has written its blocks.
+        void write(const char* data, size_t size, off_t base);
+
+        int streams(void) const { return itsStreams.size(); }
+        size_t blockSize(void) const { return itsBlockSize; }
+        bool direct(void) const { return itsDirect; }
+        bool separate(void) const { return itsSeparate; }
+
+        /// Bytes written by stream s and the time it spent writing them
+        double bytes(int s) const { return itsStreams[s].bytes; }
+        double seconds(int s) const { return itsStreams[s].seconds; }
+
+    private:
+        // Not copyable
+        StripedWriter(const StripedWriter&);
+        StripedWriter& operator=(const StripedWriter&);
+
+        struct Stream {
+            StripedWriter* owner;
+            int index;
+            pthread_t thread;
+            int fd;
+            off_t offset;
+            off_t end;
+            double bytes;
+            double seconds;
+        };
+
+        static void* run(void* arg);
+        void streamLoop(Stream& stream);
+        void writeBlocks(Stream& stream);
+
+        size_t itsBlockSize;
+        bool itsDirect;
+        bool itsSeparate;
+        std::vector<Stream> itsStreams;
+
+        pthread_mutex_t itsLock;
+        pthread_cond_t itsStart;
+        pthread_cond_t itsDone;
+
+        // Protected by itsLock
+        unsigned long itsGeneration;
+        int itsPending;
+        bool itsStop;
+
+        // The current write, set before itsGeneration changes
+        const char* itsData;
+        size_t itsSize;
+        off_t itsBase;
+};
+
+#endif
@@ -31,15 +31,26 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <vector>
+#include <algorithm>
+#include <ftw.h>
+#include <sys/stat.h>
 #include <mpi.h>
 
 // ASKAPsoft includes
 #include "CommandLineParser.h"
 #include "Common/ParameterSet.h"
 #include "casacore/casa/OS/Timer.h"
+#include "casacore/tables/Tables/Table.h"
 
 // Local includes
+#include "writers/IWriter.h"
+#include "writers/Integration.h"
+#include "writers/WriterFactory.h"
+#include "writers/AsyncWriter.h"
 #include "writers/DataSet.h"
+#include "writers/LatencyHistogram.h"
+#include "readers/DataSetReader.h"
 
 // Using
 using LOFAR::ParameterSet;
@@ -73,6 +84,193 @@ static std::string itostr(const int i)
     return str;
 }
 
+// Total size of the files under a directory, accumulated by nftw()
+static double theDiskUsage = 0.0;
+
+static int addFileSize(const char*, const struct stat* sb, int typeflag, struct FTW*)
+{
+    if (typeflag == FTW_F) {
+        theDiskUsage += sb->st_size;
+    }
+    return 0;
+}
+
+static double diskUsage(const std::string& path)
+{
+    theDiskUsage = 0.0;
+    nftw(path.c_str(), addFileSize, 16, FTW_PHYS);
+    return theDiskUsage;
+}
+
+struct SweepResult {
+    std::string layout;
+    double rate;
+    double size;
+};
+
+// Write a short measurement set for each combination of the sweep.*
+// storage manager settings, reporting the write rate (slowest process)
+// and the size on disk of each, then recommend the fastest layout.
+static void runSweep(const ParameterSet& subset, const std::string& filename,
+        const int rank)
+{
+    std::vector<int> defBucket(1, subset.getInt32("stman.bucketsize"));
+    std::vector<int> defNcorr(1, subset.getInt32("stman.tilencorr"));
+    std::vector<int> defNchan(1, subset.getInt32("stman.tilenchan"));
+    std::vector<std::string> defData(1, subset.getString("stman.data", "tiled"));
+    std::vector<std::string> defWeight(1, subset.getString("stman.weight", "tiled"));
+
+    const std::vector<int> buckets = subset.getInt32Vector("sweep.bucketsize", defBucket);
+    const std::vector<int> ncorrs = subset.getInt32Vector("sweep.tilencorr", defNcorr);
+    const std::vector<int> nchans = subset.getInt32Vector("sweep.tilenchan", defNchan);
+    const std::vector<std::string> dataMans = subset.getStringVector("sweep.data", defData);
+    const std::vector<std::string> weightMans = subset.getStringVector("sweep.weight", defWeight);
+    const int integrations = subset.getInt32("sweep.nIntegrations", 10);
+    const bool keep = subset.getBool("sweep.keep", false);
+    const double mbytes = integrations * Integration::payloadBytes(subset) / (1024.0 * 1024.0);
+
+    std::vector<SweepResult> results;
+    for (size_t b = 0; b < buckets.size(); ++b)
+    for (size_t d = 0; d < dataMans.size(); ++d)
+    for (size_t c = 0; c < ncorrs.size(); ++c)
+    for (size_t n = 0; n < nchans.size(); ++n)
+    for (size_t w = 0; w < weightMans.size(); ++w) {
+        // Tile shapes only matter for the tiled storage manager
+        if (dataMans[d] == "standard" && (c > 0 || n > 0)) {
+            continue;
+        }
+
+        ParameterSet trial(subset);
+        trial.replace("stman.bucketsize", itostr(buckets[b]));
+        trial.replace("stman.tilencorr", itostr(ncorrs[c]));
+        trial.replace("stman.tilenchan", itostr(nchans[n]));
+        trial.replace("stman.data", dataMans[d]);
+        trial.replace("stman.weight", weightMans[w]);
+        const std::string trialName = filename + "_sweep" + itostr(results.size());
+
+        std::ostringstream layout;
+        layout << "bucketsize " << buckets[b] << ", data " << dataMans[d];
+        if (dataMans[d] != "standard") {
+            layout << " [" << ncorrs[c] << "," << nchans[n] << "]";
+        }
+        layout << ", weight " << weightMans[w];
+
+        Integration integration(trial);
+        DataSet* data = new DataSet(trialName, trial);
+
+        // Time the writes and the final flush to disk, but not building
+        // the synthetic integrations, as the main mode times add() only
+        MPI_Barrier(MPI_COMM_WORLD);
+        casa::Timer timer;
+        double elapsed = 0.0;
+        for (int i = 0; i < integrations; ++i) {
+            integration.generate();
+            timer.mark();
+            data->add(integration);
+            elapsed += timer.real();
+        }
+        timer.mark();
+        delete data;
+        elapsed += timer.real();
+        double maxElapsed = 0.0;
+        MPI_Reduce(&elapsed, &maxElapsed, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+        SweepResult result;
+        result.layout = layout.str();
+        result.rate = maxElapsed > 0.0 ? mbytes / maxElapsed : 0.0;
+        result.size = diskUsage(trialName) / (1024.0 * 1024.0);
+        results.push_back(result);
+
+        if (rank == 0) {
+            std::cout << "Layout " << results.size() - 1 << " (" << result.layout << "): "
+                << result.rate << " MB/s per process, "
+                << result.size << " MB on disk" << std::endl;
+        }
+
+        if (!keep) {
+            casa::Table::deleteTable(trialName, casa::True);
+        }
+    }
+
+    if (rank == 0 && !results.empty()) {
+        size_t best = 0;
+        for (size_t i = 1; i < results.size(); ++i) {
+            if (results[i].rate > results[best].rate) {
+                best = i;
+            }
+        }
+        std::cout << "Recommended layout " << best << " (" << results[best].layout
+            << "): " << results[best].rate << " MB/s per process, "
+            << results[best].size << " MB on disk" << std::endl;
+    }
+}
+
+// Read back a dataset with each of the read.patterns, reporting GB/s per
+// pattern. With read.shared = true all processes read disjoint row ranges
+// of one dataset, otherwise each reads its own.
+static void runRead(const ParameterSet& subset, const int rank, const int nProcs)
+{
+    const bool shared = subset.getBool("read.shared", false);
+    std::string filename = subset.getString("read.filename", subset.getString("filename"));
+    const std::string pattern = "%w";
+    const size_t pos = filename.find(pattern);
+    if (pos != std::string::npos) {
+        filename.replace(pos, pattern.length(), itostr(shared ? 0 : rank));
+    }
+
+    std::vector<std::string> defPatterns;
+    defPatterns.push_back("rows");
+    defPatterns.push_back("channels");
+    defPatterns.push_back("uvw");
+    const std::vector<std::string> patterns =
+        subset.getStringVector("read.patterns", defPatterns);
+    const bool dropCache = subset.getBool("read.dropcache", true);
+
+    DataSetReader reader(filename, subset);
+    unsigned int startRow = 0;
+    unsigned int endRow = reader.nRows();
+    if (shared) {
+        const unsigned int perProc = (reader.nRows() + nProcs - 1) / nProcs;
+        startRow = std::min(reader.nRows(), rank * perProc);
+        endRow = std::min(reader.nRows(), startRow + perProc);
+    }
+    if (rank == 0) {
+        std::cout << "Reading " << filename << " (" << reader.nRows() << " rows"
+            << (shared ? ", shared by all processes)" : ")") << std::endl;
+    }
+
+    const double gb = 1024.0 * 1024.0 * 1024.0;
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        if (dropCache) {
+            reader.dropCache();
+        }
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        casa::Timer timer;
+        timer.mark();
+        double bytes = reader.read(patterns[i], startRow, endRow);
+        double elapsed = timer.real();
+        if (bytes < 0.0) {
+            if (rank == 0) {
+                std::cerr << "Unknown read pattern " << patterns[i] << std::endl;
+            }
+            continue;
+        }
+
+        double maxElapsed = 0.0;
+        double totalBytes = 0.0;
+        MPI_Reduce(&elapsed, &maxElapsed, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        MPI_Reduce(&bytes, &totalBytes, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        if (rank == 0 && maxElapsed > 0.0) {
+            std::cout << "Read pattern " << patterns[i] << ": "
+                << totalBytes / gb << " GB in " << maxElapsed << " seconds, "
+                << totalBytes / gb / maxElapsed << " GB/s total ("
+                << totalBytes / gb / maxElapsed / nProcs << " GB/s per process)"
+                << std::endl;
+        }
+    }
+}
+
 int main(int argc, char *argv[])
 {
     // MPI init
@@ -91,26 +289,107 @@ int main(int argc, char *argv[])
     int intTime = subset.getInt32("integrationTime");
     int integrations = subset.getInt32("nIntegrations");
 
-    DataSet data(filename, subset);
+    if (subset.getBool("read", false)) {
+        int nProcs;
+        MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+        runRead(subset, rank, nProcs);
+        MPI_Finalize();
+        return 0;
+    }
+
+    if (subset.getBool("sweep", false)) {
+        runSweep(subset, filename, rank);
+        MPI_Finalize();
+        return 0;
+    }
+
+    // In async mode the integrations are built here and written by the
+    // AsyncWriter's thread, which owns the writer and the buffers
+    const bool async = subset.getBool("async", false);
+    IWriter* writer = WriterFactory::create(filename, subset);
+    AsyncWriter* asyncWriter = 0;
+    Integration* integration = 0;
+    if (async) {
+        asyncWriter = new AsyncWriter(writer, subset);
+    } else {
+        integration = new Integration(subset);
+    }
+    const std::string writerName = async ? asyncWriter->name() : writer->name();
+    if (rank == 0) {
+        std::cout << "Writer: " << writerName << std::endl;
+    }
+
+    // Per-integration latencies on the slowest process, summarised at the
+    // end. With verbose = false the per-integration lines are left out.
+    const bool verbose = subset.getBool("verbose", true);
+    LatencyHistogram writeHist("Write", intTime);
+    LatencyHistogram stallHist("Stall", intTime);
+    LatencyHistogram totalHist("Total", intTime);
 
     casa::Timer timer;
+    casa::Timer addTimer;
     casa::Timer total;
+    double addTime = 0.0;
     total.mark();
     for (int i = 0; i < integrations; ++i) {
         timer.mark();
-        data.add();
+        double thisAdd = 0.0;
+        if (async) {
+            Integration& buffer = asyncWriter->acquire();
+            buffer.generate();
+            asyncWriter->submit(buffer);
+            thisAdd = asyncWriter->lastStall();
+        } else {
+            integration->generate();
+            addTimer.mark();
+            writer->add(*integration);
+            thisAdd = addTimer.real();
+            addTime += thisAdd;
+        }
+        double maxThisAdd = 0.0;
+        MPI_Reduce(&thisAdd, &maxThisAdd, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
         MPI_Barrier(MPI_COMM_WORLD);
 
         // Report progress
         if (rank == 0) {
             const float realtime = timer.real();
             const float perf = static_cast<float>(intTime) / realtime;
-            std::cout << "Wrote integration " << i <<
-            " in " << realtime << " seconds"
-            << " (" << perf << "x requirement)" << std::endl;
+            if (async) {
+                stallHist.record(maxThisAdd);
+            } else {
+                writeHist.record(maxThisAdd);
+            }
+            totalHist.record(realtime);
+            if (verbose && async) {
+                std::cout << "Queued integration " << i <<
+                " in " << realtime << " seconds"
+                << " (" << perf << "x requirement)"
+                << ", queue depth " << asyncWriter->lastQueueDepth()
+                << "/" << asyncWriter->depth()
+                << ", stalled " << asyncWriter->lastStall() << " seconds"
+                << std::endl;
+            } else if (verbose) {
+                std::cout << "Wrote integration " << i <<
+                " in " << realtime << " seconds"
+                << " (" << perf << "x requirement)" << std::endl;
+            }
         }
     }
 
+    unsigned long stalls = 0;
+    double stallTime = 0.0;
+    if (async) {
+        asyncWriter->flush();
+        MPI_Barrier(MPI_COMM_WORLD);
+        addTime = asyncWriter->writeTime();
+        stalls = asyncWriter->stalls();
+        stallTime = asyncWriter->stallTime();
+
+        // The writes run on the writer thread, out of step with the other
+        // processes, so these are the first process's write latencies
+        writeHist = asyncWriter->writeHistogram();
+    }
+
     // Report totals
     if (rank == 0) {
         const float realtime = total.real();
@@ -120,6 +399,50 @@ int main(int argc, char *argv[])
             << " (" << perf << "x requirement)" << std::endl;
     }
 
+    // Report the mean time spent in add() per integration, the figure to
+    // compare between writers and write modes. The rate counts the
+    // visibility data and metadata only, the same for every writer.
+    double maxAddTime = 0.0;
+    MPI_Reduce(&addTime, &maxAddTime, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    if (rank == 0 && integrations > 0) {
+        const double meanTime = maxAddTime / integrations;
+        const double mbytes = Integration::payloadBytes(subset) / (1024.0 * 1024.0);
+        std::cout << "Mean write time per integration ("
+            << writerName << ", slowest process): "
+            << meanTime << " seconds (" << mbytes / meanTime
+            << " MB/s per process)" << std::endl;
+    }
+
+    // Backend specific statistics, from the first process only
+    if (rank == 0) {
+        writer->report(std::cout);
+        writeHist.report(std::cout);
+        if (async) {
+            stallHist.report(std::cout);
+        }
+        totalHist.report(std::cout);
+    }
+
+    // Report how often building an integration had to wait for a free
+    // buffer, i.e. the writer thread fell behind
+    if (async) {
+        unsigned long maxStalls = 0;
+        double maxStallTime = 0.0;
+        MPI_Reduce(&stalls, &maxStalls, 1, MPI_UNSIGNED_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+        MPI_Reduce(&stallTime, &maxStallTime, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        if (rank == 0) {
+            std::cout << "Writer stalls (slowest process): " << maxStalls
+                << " totalling " << maxStallTime << " seconds" << std::endl;
+        }
+    }
+
+    if (async) {
+        delete asyncWriter;
+    } else {
+        delete integration;
+        delete writer;
+    }
+
     MPI_Finalize();
 
     return 0;
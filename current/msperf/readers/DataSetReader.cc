@@ -0,0 +1,152 @@
+/// @file readers/DataSetReader.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "DataSetReader.h"
+
+// System includes
+#include <string>
+#include <algorithm>
+#include <ftw.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// ASKAPsoft includes
+#include <Common/ParameterSet.h>
+#include <casacore/casa/Arrays/Cube.h>
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/Arrays/Slicer.h>
+#include <casacore/ms/MeasurementSets/MSColumns.h>
+
+using namespace casa;
+
+DataSetReader::DataSetReader(const std::string& filename, const LOFAR::ParameterSet& parset)
+: itsFilename(filename),
+    itsRowBlock(std::max(1, parset.getInt32("read.rowblock", 1000))),
+    itsChanBlock(std::max(1, parset.getInt32("read.nchan", 64)))
+{
+    itsMs = new MeasurementSet(filename, Table::Old);
+}
+
+DataSetReader::~DataSetReader()
+{
+    delete itsMs;
+}
+
+unsigned int DataSetReader::nRows(void) const
+{
+    return itsMs->nrow();
+}
+
+double DataSetReader::read(const std::string& pattern, unsigned int startRow,
+        unsigned int endRow)
+{
+    endRow = std::min(endRow, nRows());
+    if (startRow >= endRow) {
+        return 0.0;
+    }
+
+    if (pattern == "rows") {
+        return readRows(startRow, endRow);
+    } else if (pattern == "channels") {
+        return readChannels(startRow, endRow);
+    } else if (pattern == "uvw") {
+        return readUvw(startRow, endRow);
+    }
+    return -1.0;
+}
+
+static int dropFile(const char* path, const struct stat*, int typeflag, struct FTW*)
+{
+    if (typeflag == FTW_F) {
+        const int fd = open(path, O_RDONLY);
+        if (fd >= 0) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            close(fd);
+        }
+    }
+    return 0;
+}
+
+void DataSetReader::dropCache(void)
+{
+    nftw(itsFilename.c_str(), dropFile, 16, FTW_PHYS);
+}
+
+double DataSetReader::readRows(unsigned int startRow, unsigned int endRow)
+{
+    ROMSColumns msc(*itsMs);
+    Cube<Complex> data;
+    Cube<Bool> flag;
+    double bytes = 0.0;
+
+    for (unsigned int row = startRow; row < endRow; row += itsRowBlock) {
+        const unsigned int n = std::min(itsRowBlock, endRow - row);
+        const Slicer rows(IPosition(1, row), IPosition(1, n));
+        msc.data().getColumnRange(rows, data, True);
+        msc.flag().getColumnRange(rows, flag, True);
+        bytes += data.nelements() * sizeof(Complex) + flag.nelements() * sizeof(Bool);
+    }
+    return bytes;
+}
+
+double DataSetReader::readChannels(unsigned int startRow, unsigned int endRow)
+{
+    ROMSColumns msc(*itsMs);
+    const IPosition shape = msc.data().shape(startRow);
+    const int nPol = shape(0);
+    const int nChan = shape(1);
+    Cube<Complex> data;
+    Cube<Bool> flag;
+    double bytes = 0.0;
+
+    for (int chan = 0; chan < nChan; chan += itsChanBlock) {
+        const int n = std::min(itsChanBlock, nChan - chan);
+        const Slicer channels(IPosition(2, 0, chan), IPosition(2, nPol, n));
+        for (unsigned int row = startRow; row < endRow; row += itsRowBlock) {
+            const unsigned int nr = std::min(itsRowBlock, endRow - row);
+            const Slicer rows(IPosition(1, row), IPosition(1, nr));
+            msc.data().getColumnRange(rows, channels, data, True);
+            msc.flag().getColumnRange(rows, channels, flag, True);
+            bytes += data.nelements() * sizeof(Complex) + flag.nelements() * sizeof(Bool);
+        }
+    }
+    return bytes;
+}
+
+double DataSetReader::readUvw(unsigned int startRow, unsigned int endRow)
+{
+    ROMSColumns msc(*itsMs);
+    Matrix<Double> uvw;
+    double bytes = 0.0;
+
+    for (unsigned int row = startRow; row < endRow; row += itsRowBlock) {
+        const unsigned int n = std::min(itsRowBlock, endRow - row);
+        const Slicer rows(IPosition(1, row), IPosition(1, n));
+        msc.uvw().getColumnRange(rows, uvw, True);
+        bytes += uvw.nelements() * sizeof(Double);
+    }
+    return bytes;
+}
@@ -0,0 +1,70 @@
+/// @file readers/DataSetReader.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef DATASETREADER_H
+#define DATASETREADER_H
+
+// System includes
+#include <string>
+
+// ASKAPsoft includes
+#include "casacore/ms/MeasurementSets/MeasurementSet.h"
+#include "Common/ParameterSet.h"
+
+/// Reads back a measurement set written by msperf with the access
+/// patterns of the imaging pipeline:
+///
+/// - rows: DATA and FLAG for all channels, "read.rowblock" rows at a time
+/// - channels: DATA and FLAG for "read.nchan" channels at a time, each
+///   slice read over all rows in row blocks
+/// - uvw: the UVW column only
+class DataSetReader
+{
+    public:
+        DataSetReader(const std::string& filename, const LOFAR::ParameterSet& parset);
+        ~DataSetReader();
+
+        unsigned int nRows(void) const;
+
+        /// Read rows [startRow, endRow) with the named pattern. Returns the
+        /// number of bytes read, or -1 for an unknown pattern.
+        double read(const std::string& pattern, unsigned int startRow,
+                unsigned int endRow);
+
+        /// Ask the kernel to drop the dataset's cached pages, so the next
+        /// read comes from the storage rather than memory
+        void dropCache(void);
+
+    private:
+        double readRows(unsigned int startRow, unsigned int endRow);
+        double readChannels(unsigned int startRow, unsigned int endRow);
+        double readUvw(unsigned int startRow, unsigned int endRow);
+
+        std::string itsFilename;
+        casa::MeasurementSet* itsMs;
+        unsigned int itsRowBlock;
+        int itsChanBlock;
+};
+
+#endif
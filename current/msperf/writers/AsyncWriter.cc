@@ -0,0 +1,194 @@
+/// @file AsyncWriter.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "AsyncWriter.h"
+
+// System includes
+#include <string>
+#include <sstream>
+#include <stdexcept>
+#include <exception>
+#include <chrono>
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds(const Clock::time_point& start, const Clock::time_point& end)
+{
+    return std::chrono::duration<double>(end - start).count();
+}
+
+AsyncWriter::AsyncWriter(IWriter* writer, const LOFAR::ParameterSet& parset)
+: itsWriter(writer), itsInFlight(0), itsStop(false), itsWriteTime(0.0),
+    itsWriteHist("Write", parset.getInt32("integrationTime", 0)),
+    itsLastQueueDepth(0), itsLastStall(0.0), itsStalls(0), itsStallTime(0.0)
+{
+    int depth = parset.getInt32("async.depth", 2);
+    if (depth < 1) {
+        depth = 1;
+    }
+    for (int i = 0; i < depth; ++i) {
+        itsBuffers.push_back(new Integration(parset));
+        itsFree.push_back(itsBuffers.back());
+    }
+
+    pthread_mutex_init(&itsLock, 0);
+    pthread_cond_init(&itsChanged, 0);
+    if (pthread_create(&itsThread, 0, &AsyncWriter::run, this) != 0) {
+        throw std::runtime_error("AsyncWriter: failed to start writer thread");
+    }
+}
+
+AsyncWriter::~AsyncWriter()
+{
+    pthread_mutex_lock(&itsLock);
+    itsStop = true;
+    pthread_cond_broadcast(&itsChanged);
+    pthread_mutex_unlock(&itsLock);
+    pthread_join(itsThread, 0);
+
+    pthread_cond_destroy(&itsChanged);
+    pthread_mutex_destroy(&itsLock);
+
+    for (size_t i = 0; i < itsBuffers.size(); ++i) {
+        delete itsBuffers[i];
+    }
+    delete itsWriter;
+}
+
+Integration& AsyncWriter::acquire(void)
+{
+    const Clock::time_point start = Clock::now();
+    pthread_mutex_lock(&itsLock);
+    const bool stalled = itsFree.empty();
+    while (itsFree.empty() && itsError.empty()) {
+        pthread_cond_wait(&itsChanged, &itsLock);
+    }
+    checkError();
+    Integration* integration = itsFree.front();
+    itsFree.pop_front();
+    pthread_mutex_unlock(&itsLock);
+
+    itsLastStall = stalled ? seconds(start, Clock::now()) : 0.0;
+    if (stalled) {
+        itsStalls++;
+        itsStallTime += itsLastStall;
+    }
+    return *integration;
+}
+
+void AsyncWriter::submit(Integration& integration)
+{
+    pthread_mutex_lock(&itsLock);
+    itsQueue.push_back(&integration);
+    itsLastQueueDepth = itsQueue.size() + itsInFlight;
+    pthread_cond_broadcast(&itsChanged);
+    pthread_mutex_unlock(&itsLock);
+}
+
+void AsyncWriter::flush(void)
+{
+    pthread_mutex_lock(&itsLock);
+    while ((!itsQueue.empty() || itsInFlight > 0) && itsError.empty()) {
+        pthread_cond_wait(&itsChanged, &itsLock);
+    }
+    checkError();
+    pthread_mutex_unlock(&itsLock);
+}
+
+std::string AsyncWriter::name(void) const
+{
+    std::ostringstream ss;
+    ss << itsWriter->name() << ", async depth " << itsBuffers.size();
+    return ss.str();
+}
+
+double AsyncWriter::writeTime(void) const
+{
+    pthread_mutex_lock(&itsLock);
+    const double t = itsWriteTime;
+    pthread_mutex_unlock(&itsLock);
+    return t;
+}
+
+LatencyHistogram AsyncWriter::writeHistogram(void) const
+{
+    pthread_mutex_lock(&itsLock);
+    const LatencyHistogram hist = itsWriteHist;
+    pthread_mutex_unlock(&itsLock);
+    return hist;
+}
+
+void AsyncWriter::checkError(void)
+{
+    if (!itsError.empty()) {
+        const std::string error = itsError;
+        pthread_mutex_unlock(&itsLock);
+        throw std::runtime_error(error);
+    }
+}
+
+void* AsyncWriter::run(void* arg)
+{
+    static_cast<AsyncWriter*>(arg)->writeLoop();
+    return 0;
+}
+
+void AsyncWriter::writeLoop(void)
+{
+    pthread_mutex_lock(&itsLock);
+    for (;;) {
+        while (itsQueue.empty() && !itsStop) {
+            pthread_cond_wait(&itsChanged, &itsLock);
+        }
+        if (itsQueue.empty()) {
+            break;
+        }
+        Integration* integration = itsQueue.front();
+        itsQueue.pop_front();
+        itsInFlight++;
+        pthread_mutex_unlock(&itsLock);
+
+        const Clock::time_point start = Clock::now();
+        std::string error;
+        try {
+            itsWriter->add(*integration);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        const double elapsed = seconds(start, Clock::now());
+
+        pthread_mutex_lock(&itsLock);
+        itsInFlight--;
+        itsWriteTime += elapsed;
+        itsWriteHist.record(elapsed);
+        itsFree.push_back(integration);
+        pthread_cond_broadcast(&itsChanged);
+        if (!error.empty()) {
+            itsError = error;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&itsLock);
+}
@@ -0,0 +1,126 @@
+/// @file AsyncWriter.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef ASYNCWRITER_H
+#define ASYNCWRITER_H
+
+// System includes
+#include <string>
+#include <vector>
+#include <deque>
+#include <pthread.h>
+
+// ASKAPsoft includes
+#include "Common/ParameterSet.h"
+
+// Local includes
+#include "IWriter.h"
+#include "Integration.h"
+#include "LatencyHistogram.h"
+
+/// Hands integrations to a backend on a dedicated writer thread, so the
+/// next integration can be built while the previous one is written.
+///
+/// There are "async.depth" integration buffers (default 2, i.e. double
+/// buffering). The caller takes a free buffer with acquire(), fills it and
+/// queues it with submit(). When every buffer is queued or being written
+/// acquire() blocks; that time is counted as a stall. The time of each
+/// backend add() is kept in a histogram against "integrationTime".
+class AsyncWriter
+{
+    public:
+        /// Takes ownership of the writer
+        AsyncWriter(IWriter* writer, const LOFAR::ParameterSet& parset);
+
+        /// Waits for the queued integrations to be written
+        ~AsyncWriter();
+
+        /// Next free buffer, blocking until the writer releases one
+        Integration& acquire(void);
+
+        /// Queue a buffer returned by acquire() for writing
+        void submit(Integration& integration);
+
+        /// Wait until all queued integrations have been written
+        void flush(void);
+
+        std::string name(void) const;
+
+        /// The wrapped backend's report()
+        void report(std::ostream& os) const { itsWriter->report(os); }
+
+        /// Number of buffers
+        size_t depth(void) const { return itsBuffers.size(); }
+
+        /// Integrations queued or being written after the last submit()
+        size_t lastQueueDepth(void) const { return itsLastQueueDepth; }
+
+        /// Time the last acquire() was blocked, in seconds
+        double lastStall(void) const { return itsLastStall; }
+
+        /// Number of acquire() calls that blocked, and the total time
+        unsigned long stalls(void) const { return itsStalls; }
+        double stallTime(void) const { return itsStallTime; }
+
+        /// Total time spent in the backend's add(), in seconds
+        double writeTime(void) const;
+
+        /// Latencies of the backend's add() calls so far
+        LatencyHistogram writeHistogram(void) const;
+
+    private:
+        // Not copyable
+        AsyncWriter(const AsyncWriter&);
+        AsyncWriter& operator=(const AsyncWriter&);
+
+        static void* run(void* arg);
+        void writeLoop(void);
+
+        // Throw the writer thread's error, if any. Called with the lock held.
+        void checkError(void);
+
+        IWriter* itsWriter;
+        std::vector<Integration*> itsBuffers;
+
+        pthread_t itsThread;
+        mutable pthread_mutex_t itsLock;
+        pthread_cond_t itsChanged;
+
+        // Protected by itsLock
+        std::deque<Integration*> itsFree;
+        std::deque<Integration*> itsQueue;
+        size_t itsInFlight;
+        bool itsStop;
+        std::string itsError;
+        double itsWriteTime;
+        LatencyHistogram itsWriteHist;
+
+        // Only used by the caller's thread
+        size_t itsLastQueueDepth;
+        double itsLastStall;
+        unsigned long itsStalls;
+        double itsStallTime;
+};
+
+#endif
@@ -0,0 +1,425 @@
+/// @file CompressingWriter.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "CompressingWriter.h"
+
+// System includes
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <complex>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cerrno>
+#include <stdint.h>
+#include <unistd.h>
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds(const Clock::time_point& start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Chunk layout: this header, the row metadata, the encoded DATA column and
+// the bitpacked FLAG column
+struct ChunkHeader {
+    uint32_t magic;
+    uint32_t codec;
+    uint32_t rowStart;
+    uint32_t nRows;
+    uint64_t metaBytes;
+    uint64_t dataBytes;
+    uint64_t flagBytes;
+};
+
+static const uint32_t chunkMagic = 0x4350534d; // "MSPC"
+
+#ifdef HAVE_LZ4
+// Number of 32-bit elements shuffled together
+static const size_t shuffleBlock = 8192;
+
+// Transpose an 8x8 bit matrix held one row per byte
+static inline uint64_t transpose8(uint64_t x)
+{
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x = x ^ t ^ (t << 28);
+    return x;
+}
+
+// Bit-shuffle n 32-bit elements: within each block of elements, bit k of
+// every element is gathered into bit-plane k. Sign and exponent bits of
+// neighbouring samples are similar, so the planes compress well. Elements
+// past the last multiple of 8 are copied as is.
+static void bitshuffle(const uint32_t* in, size_t n, unsigned char* out)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(in);
+    size_t i = 0;
+    while (i + 8 <= n) {
+        const size_t block = std::min(shuffleBlock, (n - i) / 8 * 8);
+        const size_t groups = block / 8;
+        for (size_t g = 0; g < groups; ++g) {
+            const unsigned char* e = bytes + 4 * (i + 8 * g);
+            for (int b = 0; b < 4; ++b) {
+                uint64_t x = 0;
+                for (int k = 0; k < 8; ++k) {
+                    x |= static_cast<uint64_t>(e[4 * k + b]) << (8 * k);
+                }
+                x = transpose8(x);
+                for (int k = 0; k < 8; ++k) {
+                    out[(b * 8 + k) * groups + g] = static_cast<unsigned char>(x >> (8 * k));
+                }
+            }
+        }
+        out += 4 * block;
+        i += block;
+    }
+    memcpy(out, bytes + 4 * i, 4 * (n - i));
+}
+#endif
+
+// Pack one flag per bit
+static size_t bitpack(const unsigned char* flags, size_t n, unsigned char* out)
+{
+    const size_t bytes = (n + 7) / 8;
+    memset(out, 0, bytes);
+    for (size_t i = 0; i < n; ++i) {
+        if (flags[i]) {
+            out[i / 8] |= static_cast<unsigned char>(1 << (i % 8));
+        }
+    }
+    return bytes;
+}
+
+CompressingWriter::CompressingWriter(const std::string& filename,
+        const LOFAR::ParameterSet& parset)
+: PosixWriter(filename, parset), itsCodec(SCALED),
+    itsBits(parset.getInt32("compress.bits", 8)),
+    itsChunkRows(std::max(1, parset.getInt32("compress.chunkrows", 64))),
+    itsCurrent(0), itsNext(0), itsStop(false),
+    itsRawBytes(0.0), itsCompressedBytes(0.0), itsCompressTime(0.0), itsWriteTime(0.0)
+{
+    const std::string codec = parset.getString("compress.codec", "scaled");
+    if (codec == "none") {
+        itsCodec = NONE;
+    } else if (codec == "lz4") {
+#ifdef HAVE_LZ4
+        itsCodec = LZ4;
+#else
+        std::cerr << "Built without lz4, using scaled codec" << std::endl;
+#endif
+    } else if (codec != "scaled") {
+        std::cerr << "Unknown codec " << codec << ", using scaled" << std::endl;
+    }
+    itsBits = (itsBits > 8) ? 16 : 8;
+
+    pthread_mutex_init(&itsLock, 0);
+    pthread_cond_init(&itsWork, 0);
+    pthread_cond_init(&itsDone, 0);
+
+    const int nThreads = std::max(1, parset.getInt32("compress.threads", 4));
+    for (int i = 0; i < nThreads; ++i) {
+        pthread_t thread;
+        if (pthread_create(&thread, 0, &CompressingWriter::run, this) != 0) {
+            throw std::runtime_error("CompressingWriter: failed to start thread");
+        }
+        itsThreads.push_back(thread);
+    }
+}
+
+CompressingWriter::~CompressingWriter()
+{
+    pthread_mutex_lock(&itsLock);
+    itsStop = true;
+    pthread_cond_broadcast(&itsWork);
+    pthread_mutex_unlock(&itsLock);
+    for (size_t i = 0; i < itsThreads.size(); ++i) {
+        pthread_join(itsThreads[i], 0);
+    }
+
+    pthread_cond_destroy(&itsDone);
+    pthread_cond_destroy(&itsWork);
+    pthread_mutex_destroy(&itsLock);
+}
+
+void CompressingWriter::add(const Integration& integration)
+{
+    const Clock::time_point start = Clock::now();
+
+    // Size the chunks on first use, the shape is fixed for the run
+    if (itsChunks.empty()) {
+        const int nRows = integration.nRows();
+        const size_t rowCells = static_cast<size_t>(integration.nChan()) * integration.nPol();
+        for (int row = 0; row < nRows; row += itsChunkRows) {
+            Chunk chunk;
+            chunk.rowStart = row;
+            chunk.nRows = std::min(itsChunkRows, nRows - row);
+            const size_t cells = chunk.nRows * rowCells;
+            const size_t meta = chunk.nRows * (3 * sizeof(int) + 3 * sizeof(double)
+                    + 1 + 2 * integration.nPol() * sizeof(float));
+            const size_t rawData = cells * sizeof(std::complex<float>);
+            chunk.buffer.resize(sizeof(ChunkHeader) + meta + maxDataBytes(rawData)
+                    + (cells + 7) / 8);
+            if (itsCodec == LZ4) {
+                chunk.scratch.resize(rawData);
+            }
+            chunk.bytes = 0;
+            chunk.seconds = 0.0;
+            chunk.done = true;
+            itsChunks.push_back(chunk);
+        }
+    }
+
+    // Hand the chunks to the pool
+    pthread_mutex_lock(&itsLock);
+    for (size_t i = 0; i < itsChunks.size(); ++i) {
+        itsChunks[i].done = false;
+    }
+    itsCurrent = &integration;
+    itsNext = 0;
+    pthread_cond_broadcast(&itsWork);
+    pthread_mutex_unlock(&itsLock);
+
+    // Write them in order as they complete
+    for (size_t i = 0; i < itsChunks.size(); ++i) {
+        pthread_mutex_lock(&itsLock);
+        while (!itsChunks[i].done) {
+            pthread_cond_wait(&itsDone, &itsLock);
+        }
+        pthread_mutex_unlock(&itsLock);
+
+        const Chunk& chunk = itsChunks[i];
+        writeFully(&chunk.buffer[0], chunk.bytes);
+        itsCompressedBytes += chunk.bytes;
+        itsCompressTime += chunk.seconds;
+    }
+
+    pthread_mutex_lock(&itsLock);
+    itsCurrent = 0;
+    pthread_mutex_unlock(&itsLock);
+
+    if (itsSync && fdatasync(itsFd) != 0) {
+        throw std::runtime_error(itsFilename + ": fdatasync: " + strerror(errno));
+    }
+
+    itsRawBytes += integration.payloadBytes();
+    itsWriteTime += seconds(start);
+}
+
+std::string CompressingWriter::name(void) const
+{
+    std::ostringstream ss;
+    ss << "compress (";
+    switch (itsCodec) {
+        case NONE: ss << "none"; break;
+        case LZ4: ss << "lz4"; break;
+        case SCALED: ss << "scaled " << itsBits << " bit"; break;
+    }
+    ss << ", " << itsThreads.size() << " threads)";
+    return ss.str();
+}
+
+void CompressingWriter::report(std::ostream& os) const
+{
+    const double mb = 1024.0 * 1024.0;
+    os << "Compression ratio: "
+        << (itsCompressedBytes > 0 ? itsRawBytes / itsCompressedBytes : 0.0) << std::endl;
+    os << "Compression throughput: "
+        << (itsCompressTime > 0 ? itsRawBytes / mb / itsCompressTime : 0.0)
+        << " MB/s per thread" << std::endl;
+    os << "Effective write rate: "
+        << (itsWriteTime > 0 ? itsRawBytes / mb / itsWriteTime : 0.0)
+        << " MB/s uncompressed, "
+        << (itsWriteTime > 0 ? itsCompressedBytes / mb / itsWriteTime : 0.0)
+        << " MB/s to disk" << std::endl;
+}
+
+void* CompressingWriter::run(void* arg)
+{
+    static_cast<CompressingWriter*>(arg)->work();
+    return 0;
+}
+
+void CompressingWriter::work(void)
+{
+    pthread_mutex_lock(&itsLock);
+    for (;;) {
+        while (!itsStop && (itsCurrent == 0 || itsNext >= itsChunks.size())) {
+            pthread_cond_wait(&itsWork, &itsLock);
+        }
+        if (itsStop) {
+            break;
+        }
+        Chunk& chunk = itsChunks[itsNext++];
+        const Integration& integration = *itsCurrent;
+        pthread_mutex_unlock(&itsLock);
+
+        compress(integration, chunk);
+
+        pthread_mutex_lock(&itsLock);
+        chunk.done = true;
+        pthread_cond_broadcast(&itsDone);
+    }
+    pthread_mutex_unlock(&itsLock);
+}
+
+size_t CompressingWriter::maxDataBytes(size_t rawBytes) const
+{
+    switch (itsCodec) {
+#ifdef HAVE_LZ4
+        case LZ4: return LZ4_compressBound(rawBytes);
+#endif
+        case SCALED: return rawBytes / (itsBits == 8 ? 4 : 2) + rawBytes / 2;
+        default: return rawBytes;
+    }
+}
+
+void CompressingWriter::compress(const Integration& integration, Chunk& chunk) const
+{
+    const Clock::time_point start = Clock::now();
+    const int r0 = chunk.rowStart;
+    const int n = chunk.nRows;
+    const int nPol = integration.nPol();
+    const size_t cells = static_cast<size_t>(n) * integration.nChan() * nPol;
+
+    char* out = &chunk.buffer[0];
+    ChunkHeader header;
+    header.magic = chunkMagic;
+    header.codec = itsCodec;
+    header.rowStart = r0;
+    header.nRows = n;
+    char* p = out + sizeof(ChunkHeader);
+
+    // Row metadata
+    const char* meta = p;
+    memcpy(p, integration.antenna1() + r0, n * sizeof(int)); p += n * sizeof(int);
+    memcpy(p, integration.antenna2() + r0, n * sizeof(int)); p += n * sizeof(int);
+    memcpy(p, integration.feed() + r0, n * sizeof(int)); p += n * sizeof(int);
+    memcpy(p, integration.uvw() + 3 * r0, 3 * n * sizeof(double)); p += 3 * n * sizeof(double);
+    memcpy(p, integration.flagRow() + r0, n); p += n;
+    memcpy(p, integration.weight() + r0 * nPol, n * nPol * sizeof(float)); p += n * nPol * sizeof(float);
+    memcpy(p, integration.sigma() + r0 * nPol, n * nPol * sizeof(float)); p += n * nPol * sizeof(float);
+    header.metaBytes = p - meta;
+
+    header.dataBytes = encodeData(integration, chunk, p,
+            chunk.scratch.empty() ? 0 : &chunk.scratch[0]);
+    p += header.dataBytes;
+
+    const unsigned char* flags = integration.flag()
+        + static_cast<size_t>(r0) * integration.nChan() * nPol;
+    header.flagBytes = bitpack(flags, cells, reinterpret_cast<unsigned char*>(p));
+    p += header.flagBytes;
+
+    memcpy(out, &header, sizeof(ChunkHeader));
+    chunk.bytes = p - out;
+    chunk.seconds = seconds(start);
+}
+
+size_t CompressingWriter::encodeData(const Integration& integration, const Chunk& chunk,
+        char* out, char* scratch) const
+{
+    const int nChan = integration.nChan();
+    const int nPol = integration.nPol();
+    const size_t rowCells = static_cast<size_t>(nChan) * nPol;
+    const size_t cells = chunk.nRows * rowCells;
+    const std::complex<float>* vis = integration.visibilities() + chunk.rowStart * rowCells;
+    const unsigned char* flags = integration.flag() + chunk.rowStart * rowCells;
+    const size_t rawBytes = cells * sizeof(std::complex<float>);
+
+    if (itsCodec == NONE) {
+        memcpy(out, vis, rawBytes);
+        return rawBytes;
+    }
+
+#ifdef HAVE_LZ4
+    if (itsCodec == LZ4) {
+        bitshuffle(reinterpret_cast<const uint32_t*>(vis), 2 * cells,
+                reinterpret_cast<unsigned char*>(scratch));
+        const int bytes = LZ4_compress_default(scratch, out, rawBytes,
+                LZ4_compressBound(rawBytes));
+        if (bytes <= 0) {
+            throw std::runtime_error("LZ4 compression failed");
+        }
+        return bytes;
+    }
+#else
+    (void) scratch;
+#endif
+
+    // Scaled integers: per row and polarisation, one float scale followed
+    // by the real and imaginary parts of each unflagged channel
+    const float maxInt = (itsBits == 8) ? 127.0f : 32767.0f;
+    char* p = out;
+    for (int row = 0; row < chunk.nRows; ++row) {
+        const std::complex<float>* rv = vis + row * rowCells;
+        const unsigned char* rf = flags + row * rowCells;
+        for (int pol = 0; pol < nPol; ++pol) {
+            float peak = 0.0f;
+            for (int chan = 0; chan < nChan; ++chan) {
+                const size_t i = chan * nPol + pol;
+                if (!rf[i]) {
+                    peak = std::max(peak, std::max(std::abs(rv[i].real()),
+                                std::abs(rv[i].imag())));
+                }
+            }
+            const float scale = peak > 0.0f ? peak / maxInt : 1.0f;
+            const float inv = 1.0f / scale;
+            memcpy(p, &scale, sizeof(float));
+            p += sizeof(float);
+
+            if (itsBits == 8) {
+                int8_t* q = reinterpret_cast<int8_t*>(p);
+                for (int chan = 0; chan < nChan; ++chan) {
+                    const size_t i = chan * nPol + pol;
+                    const bool f = rf[i];
+                    q[2 * chan] = f ? 0 : static_cast<int8_t>(lrintf(rv[i].real() * inv));
+                    q[2 * chan + 1] = f ? 0 : static_cast<int8_t>(lrintf(rv[i].imag() * inv));
+                }
+                p += 2 * nChan * sizeof(int8_t);
+            } else {
+                int16_t* q = reinterpret_cast<int16_t*>(p);
+                for (int chan = 0; chan < nChan; ++chan) {
+                    const size_t i = chan * nPol + pol;
+                    const bool f = rf[i];
+                    q[2 * chan] = f ? 0 : static_cast<int16_t>(lrintf(rv[i].real() * inv));
+                    q[2 * chan + 1] = f ? 0 : static_cast<int16_t>(lrintf(rv[i].imag() * inv));
+                }
+                p += 2 * nChan * sizeof(int16_t);
+            }
+        }
+    }
+    return p - out;
+}
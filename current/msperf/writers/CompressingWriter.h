@@ -0,0 +1,107 @@
+/// @file CompressingWriter.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef COMPRESSINGWRITER_H
+#define COMPRESSINGWRITER_H
+
+// System includes
+#include <string>
+#include <vector>
+#include <ostream>
+#include <pthread.h>
+
+// ASKAPsoft includes
+#include "Common/ParameterSet.h"
+
+// Local includes
+#include "PosixWriter.h"
+
+/// Compresses each integration before writing it to a flat file.
+///
+/// The integration is split into chunks of "compress.chunkrows" rows which
+/// are compressed by a pool of "compress.threads" threads. Chunks are
+/// written in order as soon as they are ready, so the write of one chunk
+/// overlaps the compression of the following ones. Each chunk holds the
+/// row metadata uncompressed, the DATA column encoded with
+/// "compress.codec" and the FLAG column bitpacked. The codecs are:
+///
+/// - none: DATA is copied as is
+/// - lz4: DATA is bit-shuffled then compressed with LZ4 (lossless, needs
+///   the lz4 library)
+/// - scaled: DATA is stored as "compress.bits" (8 or 16) bit integers
+///   scaled by the peak of each row and polarisation, a lossy encoding in
+///   the style of Dysco. Flagged samples are stored as zero.
+class CompressingWriter : public PosixWriter
+{
+    public:
+        CompressingWriter(const std::string& filename, const LOFAR::ParameterSet& parset);
+        virtual ~CompressingWriter();
+
+        virtual void add(const Integration& integration);
+        virtual std::string name(void) const;
+        virtual void report(std::ostream& os) const;
+
+    private:
+        enum Codec { NONE, LZ4, SCALED };
+
+        struct Chunk {
+            int rowStart;
+            int nRows;
+            std::vector<char> buffer;
+            std::vector<char> scratch;
+            size_t bytes;
+            double seconds;
+            bool done;
+        };
+
+        static void* run(void* arg);
+        void work(void);
+        void compress(const Integration& integration, Chunk& chunk) const;
+        size_t encodeData(const Integration& integration, const Chunk& chunk,
+                char* out, char* scratch) const;
+        size_t maxDataBytes(size_t rawBytes) const;
+
+        Codec itsCodec;
+        int itsBits;
+        int itsChunkRows;
+
+        std::vector<pthread_t> itsThreads;
+        pthread_mutex_t itsLock;
+        pthread_cond_t itsWork;
+        pthread_cond_t itsDone;
+
+        // Protected by itsLock
+        const Integration* itsCurrent;
+        std::vector<Chunk> itsChunks;
+        size_t itsNext;
+        bool itsStop;
+
+        // Statistics
+        double itsRawBytes;
+        double itsCompressedBytes;
+        double itsCompressTime;
+        double itsWriteTime;
+};
+
+#endif
@@ -34,7 +34,10 @@
 
 // ASKAPsoft includes
 #include <Common/ParameterSet.h>
+#include <casacore/casa/Arrays/Vector.h>
 #include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/Arrays/Cube.h>
+#include <casacore/casa/Arrays/Slicer.h>
 #include <casacore/tables/Tables/TableDesc.h>
 #include <casacore/tables/Tables/SetupNewTab.h>
 #include <casacore/tables/Tables/IncrementalStMan.h>
@@ -46,8 +49,15 @@ using namespace casa;
 using LOFAR::ParameterSet;
 
 DataSet::DataSet(const std::string& filename, const LOFAR::ParameterSet& parset)
-: itsParset(parset)
+: itsParset(parset), itsBulk(false)
 {
+    const std::string mode = itsParset.getString("writemode", "row");
+    if (mode == "bulk") {
+        itsBulk = true;
+    } else if (mode != "row") {
+        std::cerr << "Unknown writemode " << mode << ", using row" << std::endl;
+    }
+
     create(filename);
     initAnt();
     initFields();
@@ -61,27 +71,51 @@ DataSet::~DataSet()
     delete itsMs;
 }
 
-void DataSet::add(void)
+void DataSet::add(const Integration& integration)
 {
     MSColumns msc(*itsMs);
 
-    const int intTime = itsParset.getInt32("integrationTime"); 
-    const int nAnt = itsParset.getInt32("nAntenna");
-    const int nChan = itsParset.getInt32("nChan");
-    const int nCorr = itsParset.getInt32("nPol");
-    const int nFeeds = itsParset.getInt32("nFeeds");
-    const int nBaselines = nAnt * (nAnt + 1) / 2;
-
     // Save row cursor
-    int row = itsMs->nrow();
+    const int row = itsMs->nrow();
+
+    itsMs->addRow(integration.nRows());
+
+    if (itsBulk) {
+        addBulk(msc, row, integration);
+    } else {
+        addRows(msc, row, integration);
+    }
+
+    addPointing(msc);
+}
+
+std::string DataSet::name(void) const
+{
+    return itsBulk ? "ms (bulk)" : "ms (row)";
+}
+
+// The casa arrays below refer to the integration record in place (SHARE),
+// so neither write path copies the visibilities.
+template <typename T, typename S>
+static T* storage(const S* column)
+{
+    return const_cast<T*>(reinterpret_cast<const T*>(column));
+}
 
-    itsMs->addRow(nFeeds*nBaselines);
+void DataSet::addRows(MSColumns& msc, const int startRow, const Integration& integration)
+{
+    const int intTime = itsParset.getInt32("integrationTime"); 
+    const int nAnt = integration.nAntenna();
+    const int nChan = integration.nChan();
+    const int nCorr = integration.nPol();
+    const int nFeeds = integration.nFeeds();
 
-    Matrix<Complex> data(nCorr,nChan);
-    data.set(Complex(0.0));
+    int row = startRow;
+    size_t r = 0;
 
-    Matrix<Bool> flag(nCorr,nChan);
-    flag = False;
+    const IPosition cellShape(2, nCorr, nChan);
+    const IPosition corrShape(1, nCorr);
+    const size_t cellsPerRow = nCorr * nChan;
 
     for (int feed = 0; feed < nFeeds; ++feed) {
 
@@ -103,32 +137,90 @@ void DataSet::add(void)
         for (int ant1 = 0; ant1 < nAnt; ++ant1) {
             const int startAnt = ant1;
             for (int ant2 = startAnt; ant2 < nAnt; ++ant2) {
-                msc.antenna1().put(row,ant1);
-                msc.antenna2().put(row,ant2);
-                msc.feed1().put(row,feed);
-                msc.feed2().put(row,feed);
-
-                Vector<double> uvwvec(3);
-                uvwvec(0) = 1;
-                uvwvec(1) = 2;
-                uvwvec(2) = 3;
+                msc.antenna1().put(row, integration.antenna1()[r]);
+                msc.antenna2().put(row, integration.antenna2()[r]);
+                msc.feed1().put(row, integration.feed()[r]);
+                msc.feed2().put(row, integration.feed()[r]);
+
+                const Vector<Double> uvwvec(IPosition(1, 3),
+                        storage<Double>(integration.uvw() + 3 * r), SHARE);
                 msc.uvw().put(row,uvwvec);
 
+                const Matrix<Complex> data(cellShape,
+                        storage<Complex>(integration.visibilities() + r * cellsPerRow), SHARE);
+                const Matrix<Bool> flag(cellShape,
+                        storage<Bool>(integration.flag() + r * cellsPerRow), SHARE);
                 msc.data().put(row, data);
                 msc.flag().put(row, flag);
-                msc.flagRow().put(row, False);
+                msc.flagRow().put(row, integration.flagRow()[r] != 0);
 
-                Vector<Float> weight(nCorr);
-                weight = 4.0;
-                Vector<Float> sigma(nCorr);
-                sigma = 5.0;
+                const Vector<Float> weight(corrShape,
+                        storage<Float>(integration.weight() + r * nCorr), SHARE);
+                const Vector<Float> sigma(corrShape,
+                        storage<Float>(integration.sigma() + r * nCorr), SHARE);
                 msc.weight().put(row, weight);
                 msc.sigma().put(row, sigma);
 
                 row++;
+                r++;
             } // Ant2
         } // Ant1
     } // Feed
+}
+
+void DataSet::addBulk(MSColumns& msc, const int startRow, const Integration& integration)
+{
+    const int intTime = itsParset.getInt32("integrationTime"); 
+    const int nChan = integration.nChan();
+    const int nCorr = integration.nPol();
+    const int nRows = integration.nRows();
+
+    // The incremental storage manager keeps these values for the following
+    // rows, so they are only put once per integration.
+    msc.scanNumber().put(startRow, 0);
+    msc.fieldId().put(startRow, 0);
+    msc.dataDescId().put(startRow, 0);
+    msc.time().put(startRow, 0 );
+    msc.arrayId().put(startRow, 0);
+    msc.processorId().put(startRow, 0);
+    msc.exposure().put(startRow, intTime);
+    msc.interval().put(startRow, intTime);
+    msc.observationId().put(startRow, 0);
+    msc.stateId().put(startRow, -1);
+
+    const IPosition rowShape(1, nRows);
+    const Vector<Int> ant1(rowShape, storage<Int>(integration.antenna1()), SHARE);
+    const Vector<Int> ant2(rowShape, storage<Int>(integration.antenna2()), SHARE);
+    const Vector<Int> feed(rowShape, storage<Int>(integration.feed()), SHARE);
+    const Vector<Bool> flagRow(rowShape, storage<Bool>(integration.flagRow()), SHARE);
+    const Matrix<Double> uvw(IPosition(2, 3, nRows),
+            storage<Double>(integration.uvw()), SHARE);
+    const Cube<Complex> data(IPosition(3, nCorr, nChan, nRows),
+            storage<Complex>(integration.visibilities()), SHARE);
+    const Cube<Bool> flag(IPosition(3, nCorr, nChan, nRows),
+            storage<Bool>(integration.flag()), SHARE);
+    const Matrix<Float> weight(IPosition(2, nCorr, nRows),
+            storage<Float>(integration.weight()), SHARE);
+    const Matrix<Float> sigma(IPosition(2, nCorr, nRows),
+            storage<Float>(integration.sigma()), SHARE);
+
+    // One put per column for all rows of the integration
+    const Slicer rows(IPosition(1, startRow), IPosition(1, nRows));
+    msc.antenna1().putColumnRange(rows, ant1);
+    msc.antenna2().putColumnRange(rows, ant2);
+    msc.feed1().putColumnRange(rows, feed);
+    msc.feed2().putColumnRange(rows, feed);
+    msc.uvw().putColumnRange(rows, uvw);
+    msc.data().putColumnRange(rows, data);
+    msc.flag().putColumnRange(rows, flag);
+    msc.flagRow().putColumnRange(rows, flagRow);
+    msc.weight().putColumnRange(rows, weight);
+    msc.sigma().putColumnRange(rows, sigma);
+}
+
+void DataSet::addPointing(MSColumns& msc)
+{
+    const int nAnt = itsParset.getInt32("nAntenna");
 
     // Add pointing
     int pointingRow = itsMs->pointing().nrow();
@@ -162,6 +254,10 @@ void DataSet::create(const std::string& filename)
         tileNchan = 1;
     }
 
+    // Storage manager for the bulk columns, "tiled" (default) or "standard"
+    const bool tiledData = itsParset.getString("stman.data", "tiled") != "standard";
+    const bool tiledWeight = itsParset.getString("stman.weight", "tiled") != "standard";
+
     std::cout << "Creating dataset " << filename << std::endl;
 
     // Make MS with standard columns
@@ -190,7 +286,7 @@ void DataSet::create(const std::string& filename)
     }
 
     // These columns contain the bulk of the data so save them in a tiled way
-    {
+    if (tiledData) {
         // Get nr of rows in a tile.
         int nrowTile = std::max(1, bucketSize / (8*tileNcorr*tileNchan));
         TiledShapeStMan dataMan("TiledData",
@@ -199,8 +295,14 @@ void DataSet::create(const std::string& filename)
                 dataMan);
         newMS.bindColumn(MeasurementSet::columnName(MeasurementSet::FLAG),
                 dataMan);
+    } else {
+        StandardStMan dataMan("ssmbulk", bucketSize);
+        newMS.bindColumn(MeasurementSet::columnName(MeasurementSet::DATA),
+                dataMan);
+        newMS.bindColumn(MeasurementSet::columnName(MeasurementSet::FLAG),
+                dataMan);
     }
-    {
+    if (tiledWeight) {
         int nrowTile = std::max(1, bucketSize / (4*8));
         TiledShapeStMan dataMan("TiledWeight",
                 IPosition(2,4,nrowTile));
@@ -208,6 +310,12 @@ void DataSet::create(const std::string& filename)
                 dataMan);
         newMS.bindColumn(MeasurementSet::columnName(MeasurementSet::WEIGHT),
                 dataMan);
+    } else {
+        StandardStMan dataMan("ssmweight", bucketSize);
+        newMS.bindColumn(MeasurementSet::columnName(MeasurementSet::SIGMA),
+                dataMan);
+        newMS.bindColumn(MeasurementSet::columnName(MeasurementSet::WEIGHT),
+                dataMan);
     }
 
     // Now we can create the MeasurementSet and add the (empty) subtables
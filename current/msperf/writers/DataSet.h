@@ -32,15 +32,25 @@
 
 // ASKAPsoft includes
 #include "casacore/ms/MeasurementSets/MeasurementSet.h"
+#include "casacore/ms/MeasurementSets/MSColumns.h"
 #include "Common/ParameterSet.h"
 
-class DataSet
+// Local includes
+#include "IWriter.h"
+
+/// Writes integrations to a casacore measurement set
+class DataSet : public IWriter
 {
     public:
         DataSet(const std::string& filename, const LOFAR::ParameterSet& parset);
-        ~DataSet();
+        virtual ~DataSet();
+
+        /// Write one integration, using the mode given by the "writemode"
+        /// parameter: "row" (default) puts each column one row at a time,
+        /// "bulk" puts each column for the whole integration at once.
+        virtual void add(const Integration& integration);
 
-        void add(void);
+        virtual std::string name(void) const;
 
     private:
         void create(const std::string& filename);
@@ -50,8 +60,15 @@ class DataSet
         void initFeeds(void);
         void initObs(void);
 
+        void addRows(casa::MSColumns& msc, const int startRow,
+                const Integration& integration);
+        void addBulk(casa::MSColumns& msc, const int startRow,
+                const Integration& integration);
+        void addPointing(casa::MSColumns& msc);
+
         casa::MeasurementSet* itsMs;
         LOFAR::ParameterSet itsParset;
+        bool itsBulk;
 };
 
 #endif
@@ -0,0 +1,47 @@
+/// @file DirectWriter.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef DIRECTWRITER_H
+#define DIRECTWRITER_H
+
+// System includes
+#include <string>
+
+// ASKAPsoft includes
+#include "Common/ParameterSet.h"
+
+// Local includes
+#include "PosixWriter.h"
+
+/// Writes each integration record with O_DIRECT, bypassing the page cache.
+/// The Integration record is already aligned and padded for this.
+class DirectWriter : public PosixWriter
+{
+    public:
+        DirectWriter(const std::string& filename, const LOFAR::ParameterSet& parset);
+
+        virtual std::string name(void) const;
+};
+
+#endif
@@ -0,0 +1,187 @@
+/// @file Integration.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "Integration.h"
+
+// System includes
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <algorithm>
+#include <string>
+#include <iostream>
+#include <stdint.h>
+
+// ASKAPsoft includes
+#include "Common/ParameterSet.h"
+
+size_t Integration::layout(int nRows, int nChan, int nPol, size_t* offsets)
+{
+    const size_t rows = nRows;
+    const size_t cells = rows * nChan * nPol;
+    size_t bytes[NCOLUMNS];
+    bytes[ANTENNA1] = rows * sizeof(int);
+    bytes[ANTENNA2] = rows * sizeof(int);
+    bytes[FEED] = rows * sizeof(int);
+    bytes[UVW] = 3 * rows * sizeof(double);
+    bytes[DATA] = cells * sizeof(std::complex<float>);
+    bytes[FLAG] = cells;
+    bytes[FLAG_ROW] = rows;
+    bytes[WEIGHT] = rows * nPol * sizeof(float);
+    bytes[SIGMA] = rows * nPol * sizeof(float);
+
+    // Keep each column 8 byte aligned
+    size_t offset = 0;
+    for (int c = 0; c < NCOLUMNS; ++c) {
+        if (offsets) {
+            offsets[c] = offset;
+        }
+        offset += (bytes[c] + 7) & ~static_cast<size_t>(7);
+    }
+    return offset;
+}
+
+size_t Integration::payloadBytes(const LOFAR::ParameterSet& parset)
+{
+    const int nAnt = parset.getInt32("nAntenna");
+    const int nRows = parset.getInt32("nFeeds") * nAnt * (nAnt + 1) / 2;
+    return layout(nRows, parset.getInt32("nChan"), parset.getInt32("nPol"), 0);
+}
+
+Integration::Integration(const LOFAR::ParameterSet& parset)
+: itsNAntenna(parset.getInt32("nAntenna")),
+    itsNChan(parset.getInt32("nChan")),
+    itsNPol(parset.getInt32("nPol")),
+    itsNFeeds(parset.getInt32("nFeeds")),
+    itsSynthetic(true), itsIndex(0),
+    itsRecord(0)
+{
+    const std::string data = parset.getString("data", "synthetic");
+    if (data == "zero") {
+        itsSynthetic = false;
+    } else if (data != "synthetic") {
+        std::cerr << "Unknown data " << data << ", using synthetic" << std::endl;
+    }
+
+    itsPayloadBytes = layout(nRows(), itsNChan, itsNPol, itsOffset);
+    itsSize = (itsPayloadBytes + alignment - 1) / alignment * alignment;
+
+    void* p = 0;
+    if (posix_memalign(&p, alignment, itsSize) != 0) {
+        throw std::bad_alloc();
+    }
+    itsRecord = static_cast<char*>(p);
+    memset(itsRecord, 0, itsSize);
+
+    generate();
+}
+
+Integration::~Integration()
+{
+    free(itsRecord);
+}
+
+void Integration::generate(void)
+{
+    int row = 0;
+    for (int feed = 0; feed < itsNFeeds; ++feed) {
+        for (int ant1 = 0; ant1 < itsNAntenna; ++ant1) {
+            for (int ant2 = ant1; ant2 < itsNAntenna; ++ant2) {
+                antenna1()[row] = ant1;
+                antenna2()[row] = ant2;
+                this->feed()[row] = feed;
+                uvw()[3 * row] = 1;
+                uvw()[3 * row + 1] = 2;
+                uvw()[3 * row + 2] = 3;
+                flagRow()[row] = 0;
+                for (int pol = 0; pol < itsNPol; ++pol) {
+                    weight()[row * itsNPol + pol] = 4.0;
+                    sigma()[row * itsNPol + pol] = 5.0;
+                }
+                if (itsSynthetic) {
+                    generateRow(row, ant1, ant2, feed);
+                }
+                row++;
+            }
+        }
+    }
+
+    if (!itsSynthetic) {
+        const size_t cells = static_cast<size_t>(nRows()) * itsNChan * itsNPol;
+        std::fill(visibilities(), visibilities() + cells, std::complex<float>(0.0, 0.0));
+        std::fill(flag(), flag() + cells, 0);
+    }
+    itsIndex++;
+}
+
+// Cheap uniform noise in [-0.5, 0.5), seeded per row
+static inline float noise(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state >> 8) * (1.0f / 16777216.0f) - 0.5f;
+}
+
+void Integration::generateRow(int row, int ant1, int ant2, int feed)
+{
+    uint32_t state = 0x9e3779b9u ^ (row * 2654435761u) ^ (itsIndex * 40503u);
+    if (state == 0) {
+        state = 1;
+    }
+
+    // A single fringing source in the parallel hands, the phase turning
+    // across the band at a rate set by the baseline and slowly between
+    // integrations. Auto-correlations are real and much brighter. The
+    // noise (roughly unit variance) dominates, as it does for ASKAP.
+    const bool autoCorr = (ant1 == ant2);
+    const float amplitude = autoCorr ? 100.0f : 1.0f;
+    const float rate = 0.002f * (ant2 - ant1) * (feed + 1);
+    const std::complex<float> step(std::cos(rate), std::sin(rate));
+    const float start = 0.01f * itsIndex * (ant2 - ant1);
+    std::complex<float> phasor(std::cos(start), std::sin(start));
+
+    // A band of channels lost to RFI, plus about 1% flagged at random
+    const int rfiStart = itsNChan * 5 / 16;
+    const int rfiEnd = itsNChan * 6 / 16;
+
+    std::complex<float>* vis = visibilities() + static_cast<size_t>(row) * itsNChan * itsNPol;
+    unsigned char* flags = flag() + static_cast<size_t>(row) * itsNChan * itsNPol;
+    for (int chan = 0; chan < itsNChan; ++chan) {
+        const bool flagged = (chan >= rfiStart && chan < rfiEnd) || noise(state) > 0.49f;
+        for (int pol = 0; pol < itsNPol; ++pol) {
+            const bool parallel = (pol == 0 || pol == itsNPol - 1);
+            std::complex<float> v(2.5f * (noise(state) + noise(state)),
+                    autoCorr ? 0.0f : 2.5f * (noise(state) + noise(state)));
+            if (parallel) {
+                v += amplitude * (autoCorr ? std::complex<float>(1.0f, 0.0f) : phasor);
+            }
+            vis[chan * itsNPol + pol] = v;
+            flags[chan * itsNPol + pol] = flagged;
+        }
+        phasor *= step;
+    }
+}
@@ -0,0 +1,133 @@
+/// @file Integration.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef INTEGRATION_H
+#define INTEGRATION_H
+
+// System includes
+#include <complex>
+#include <cstddef>
+
+// ASKAPsoft includes
+#include "Common/ParameterSet.h"
+
+/// One integration of visibilities, as handed to the writer backends. The
+/// shape is given by nAntenna, nChan, nPol and nFeeds, with one row per
+/// feed and baseline (auto-correlations included).
+///
+/// The columns are held in a single record, in the order antenna1,
+/// antenna2, feed, uvw, data, flag, flagRow, weight, sigma. Within a column
+/// the layout matches the measurement set, polarisation varying fastest,
+/// then channel, then row. The record is aligned and padded to
+/// Integration::alignment bytes so it can be written with O_DIRECT.
+class Integration
+{
+    public:
+        Integration(const LOFAR::ParameterSet& parset);
+        ~Integration();
+
+        static const size_t alignment = 4096;
+
+        int nAntenna(void) const { return itsNAntenna; }
+        int nChan(void) const { return itsNChan; }
+        int nPol(void) const { return itsNPol; }
+        int nFeeds(void) const { return itsNFeeds; }
+        int nBaselines(void) const { return itsNAntenna * (itsNAntenna + 1) / 2; }
+        int nRows(void) const { return itsNFeeds * nBaselines(); }
+
+        /// Bytes of visibility data and metadata in one integration
+        size_t payloadBytes(void) const { return itsPayloadBytes; }
+
+        /// payloadBytes() for the given shape, without allocating a record
+        static size_t payloadBytes(const LOFAR::ParameterSet& parset);
+
+        /// Size of the record, payloadBytes() rounded up to the alignment
+        size_t size(void) const { return itsSize; }
+
+        /// Rewrite every column, as the ingest pipeline would for each new
+        /// integration. With "data = synthetic" (the default) the
+        /// visibilities are a fringing point source plus noise and a few
+        /// percent are flagged, so they compress like real data; with
+        /// "data = zero" they are all zero and unflagged.
+        void generate(void);
+
+        const char* data(void) const { return itsRecord; }
+        char* data(void) { return itsRecord; }
+
+        int* antenna1(void) { return column<int>(ANTENNA1); }
+        int* antenna2(void) { return column<int>(ANTENNA2); }
+        int* feed(void) { return column<int>(FEED); }
+        double* uvw(void) { return column<double>(UVW); }
+        std::complex<float>* visibilities(void) { return column<std::complex<float> >(DATA); }
+        unsigned char* flag(void) { return column<unsigned char>(FLAG); }
+        unsigned char* flagRow(void) { return column<unsigned char>(FLAG_ROW); }
+        float* weight(void) { return column<float>(WEIGHT); }
+        float* sigma(void) { return column<float>(SIGMA); }
+
+        const int* antenna1(void) const { return column<int>(ANTENNA1); }
+        const int* antenna2(void) const { return column<int>(ANTENNA2); }
+        const int* feed(void) const { return column<int>(FEED); }
+        const double* uvw(void) const { return column<double>(UVW); }
+        const std::complex<float>* visibilities(void) const
+            { return column<std::complex<float> >(DATA); }
+        const unsigned char* flag(void) const { return column<unsigned char>(FLAG); }
+        const unsigned char* flagRow(void) const { return column<unsigned char>(FLAG_ROW); }
+        const float* weight(void) const { return column<float>(WEIGHT); }
+        const float* sigma(void) const { return column<float>(SIGMA); }
+
+    private:
+        // Not copyable
+        Integration(const Integration&);
+        Integration& operator=(const Integration&);
+
+        enum Column { ANTENNA1, ANTENNA2, FEED, UVW, DATA, FLAG, FLAG_ROW,
+            WEIGHT, SIGMA, NCOLUMNS };
+
+        /// Work out the column offsets, returning the payload size
+        static size_t layout(int nRows, int nChan, int nPol, size_t* offsets);
+
+        template <typename T>
+        T* column(Column c) { return reinterpret_cast<T*>(itsRecord + itsOffset[c]); }
+
+        template <typename T>
+        const T* column(Column c) const
+            { return reinterpret_cast<const T*>(itsRecord + itsOffset[c]); }
+
+        void generateRow(int row, int ant1, int ant2, int feed);
+
+        int itsNAntenna;
+        int itsNChan;
+        int itsNPol;
+        int itsNFeeds;
+        bool itsSynthetic;
+        unsigned int itsIndex;
+
+        size_t itsOffset[NCOLUMNS];
+        size_t itsPayloadBytes;
+        size_t itsSize;
+
+        char* itsRecord;
+};
+
+#endif
@@ -0,0 +1,108 @@
+/// @file LatencyHistogram.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "LatencyHistogram.h"
+
+// System includes
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+LatencyHistogram::LatencyHistogram(const std::string& name, double deadline)
+: itsName(name), itsDeadline(deadline), itsCounts((64 - subBucketBits + 1) * subBuckets, 0),
+    itsCount(0), itsMisses(0), itsSum(0.0), itsMax(0.0)
+{
+}
+
+size_t LatencyHistogram::bucketIndex(unsigned long long us)
+{
+    // Values below 2 * subBuckets map one to one, above that each power of
+    // two range has subBuckets buckets
+    if (us < 2 * static_cast<unsigned long long>(subBuckets)) {
+        return us;
+    }
+    int msb = 0;
+    for (unsigned long long v = us; v > 1; v >>= 1) {
+        msb++;
+    }
+    const int shift = msb - subBucketBits;
+    return (shift + 1) * subBuckets + (us >> shift) - subBuckets;
+}
+
+unsigned long long LatencyHistogram::bucketValue(size_t index)
+{
+    // Highest value that maps to the bucket
+    if (index < 2 * static_cast<size_t>(subBuckets)) {
+        return index;
+    }
+    const int shift = index / subBuckets - 1;
+    const unsigned long long sub = index % subBuckets + subBuckets;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(double seconds)
+{
+    const double us = std::max(0.0, seconds * 1e6);
+    const size_t index = std::min(bucketIndex(static_cast<unsigned long long>(us)),
+            itsCounts.size() - 1);
+    itsCounts[index]++;
+    itsCount++;
+    itsSum += seconds;
+    itsMax = std::max(itsMax, seconds);
+    if (itsDeadline > 0.0 && seconds > itsDeadline) {
+        itsMisses++;
+    }
+}
+
+double LatencyHistogram::percentile(double percent) const
+{
+    if (itsCount == 0) {
+        return 0.0;
+    }
+    const unsigned long target = std::max(1UL,
+            static_cast<unsigned long>(std::ceil(percent / 100.0 * itsCount)));
+    unsigned long seen = 0;
+    for (size_t i = 0; i < itsCounts.size(); ++i) {
+        seen += itsCounts[i];
+        if (seen >= target) {
+            return std::min(itsMax, bucketValue(i) * 1e-6);
+        }
+    }
+    return itsMax;
+}
+
+void LatencyHistogram::report(std::ostream& os) const
+{
+    os << itsName << " latency (s): count " << itsCount
+        << ", mean " << mean()
+        << ", p50 " << percentile(50.0)
+        << ", p99 " << percentile(99.0)
+        << ", p99.9 " << percentile(99.9)
+        << ", max " << itsMax;
+    if (itsDeadline > 0.0) {
+        os << ", " << itsMisses << " missed the " << itsDeadline << " s deadline";
+    }
+    os << std::endl;
+}
@@ -0,0 +1,75 @@
+/// @file LatencyHistogram.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+// System includes
+#include <string>
+#include <vector>
+#include <ostream>
+
+/// Histogram of latencies in the style of HdrHistogram. Values are kept
+/// in microseconds in log-linear buckets: each power of two range is split
+/// into 128 linear sub-buckets, so any percentile is within 1% of the true
+/// value however long the run, in a fixed 64KB.
+class LatencyHistogram
+{
+    public:
+        /// A deadline (in seconds) greater than zero counts the values
+        /// exceeding it
+        LatencyHistogram(const std::string& name, double deadline = 0.0);
+
+        /// Record one value, in seconds
+        void record(double seconds);
+
+        unsigned long count(void) const { return itsCount; }
+        unsigned long misses(void) const { return itsMisses; }
+        double max(void) const { return itsMax; }
+        double mean(void) const { return itsCount ? itsSum / itsCount : 0.0; }
+
+        /// Value (in seconds) below which the given percentage of values fall
+        double percentile(double percent) const;
+
+        /// One line summary: count, mean, p50, p99, p99.9, max and any
+        /// deadline misses
+        void report(std::ostream& os) const;
+
+    private:
+        static const int subBucketBits = 7;
+        static const int subBuckets = 1 << subBucketBits;
+
+        static size_t bucketIndex(unsigned long long us);
+        static unsigned long long bucketValue(size_t index);
+
+        std::string itsName;
+        double itsDeadline;
+        std::vector<unsigned long long> itsCounts;
+        unsigned long itsCount;
+        unsigned long itsMisses;
+        double itsSum;
+        double itsMax;
+};
+
+#endif
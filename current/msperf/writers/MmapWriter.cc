@@ -0,0 +1,86 @@
+/// @file MmapWriter.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "MmapWriter.h"
+
+// System includes
+#include <string>
+#include <iostream>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+MmapWriter::MmapWriter(const std::string& filename, const LOFAR::ParameterSet&)
+: itsFilename(filename), itsFd(-1), itsOffset(0)
+{
+    std::cout << "Creating file " << itsFilename << std::endl;
+    itsFd = open(itsFilename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (itsFd < 0) {
+        throw std::runtime_error(itsFilename + ": open: " + strerror(errno));
+    }
+}
+
+MmapWriter::~MmapWriter()
+{
+    if (itsFd >= 0) {
+        close(itsFd);
+    }
+}
+
+void MmapWriter::add(const Integration& integration)
+{
+    // Records are 4096 byte aligned, which need not be a whole page (64KB
+    // pages on some aarch64 and ppc64le systems), so map from the page
+    // boundary at or below the offset and copy in at the difference
+    static const off_t page = sysconf(_SC_PAGESIZE);
+    const size_t size = integration.size();
+    if (ftruncate(itsFd, itsOffset + size) != 0) {
+        throw std::runtime_error(itsFilename + ": ftruncate: " + strerror(errno));
+    }
+
+    const off_t start = itsOffset / page * page;
+    const size_t delta = itsOffset - start;
+    void* p = mmap(0, delta + size, PROT_WRITE, MAP_SHARED, itsFd, start);
+    if (p == MAP_FAILED) {
+        throw std::runtime_error(itsFilename + ": mmap: " + strerror(errno));
+    }
+
+    memcpy(static_cast<char*>(p) + delta, integration.data(), size);
+    const int status = msync(p, delta + size, MS_SYNC);
+    munmap(p, delta + size);
+    if (status != 0) {
+        throw std::runtime_error(itsFilename + ": msync: " + strerror(errno));
+    }
+
+    itsOffset += size;
+}
+
+std::string MmapWriter::name(void) const
+{
+    return "mmap";
+}
@@ -0,0 +1,55 @@
+/// @file MmapWriter.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef MMAPWRITER_H
+#define MMAPWRITER_H
+
+// System includes
+#include <string>
+#include <sys/types.h>
+
+// ASKAPsoft includes
+#include "Common/ParameterSet.h"
+
+// Local includes
+#include "IWriter.h"
+
+/// Extends the file by one record per integration, maps the new region,
+/// copies the record in and flushes it with msync(MS_SYNC).
+class MmapWriter : public IWriter
+{
+    public:
+        MmapWriter(const std::string& filename, const LOFAR::ParameterSet& parset);
+        virtual ~MmapWriter();
+
+        virtual void add(const Integration& integration);
+        virtual std::string name(void) const;
+
+    private:
+        std::string itsFilename;
+        int itsFd;
+        off_t itsOffset;
+};
+
+#endif
@@ -0,0 +1,94 @@
+/// @file PosixWriter.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "PosixWriter.h"
+
+// System includes
+#include <string>
+#include <iostream>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+PosixWriter::PosixWriter(const std::string& filename, const LOFAR::ParameterSet& parset)
+: itsFilename(filename), itsFd(-1),
+    itsSync(parset.getBool("sync", false))
+{
+    open(0);
+}
+
+PosixWriter::PosixWriter(const std::string& filename, const LOFAR::ParameterSet& parset,
+        int flags)
+: itsFilename(filename), itsFd(-1),
+    itsSync(parset.getBool("sync", false))
+{
+    open(flags);
+}
+
+PosixWriter::~PosixWriter()
+{
+    if (itsFd >= 0) {
+        close(itsFd);
+    }
+}
+
+void PosixWriter::add(const Integration& integration)
+{
+    writeFully(integration.data(), integration.size());
+    if (itsSync && fdatasync(itsFd) != 0) {
+        throw std::runtime_error(itsFilename + ": fdatasync: " + strerror(errno));
+    }
+}
+
+std::string PosixWriter::name(void) const
+{
+    return itsSync ? "posix (fdatasync)" : "posix";
+}
+
+void PosixWriter::writeFully(const char* buf, size_t n)
+{
+    while (n > 0) {
+        const ssize_t written = write(itsFd, buf, n);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(itsFilename + ": write: " + strerror(errno));
+        }
+        buf += written;
+        n -= written;
+    }
+}
+
+void PosixWriter::open(int flags)
+{
+    std::cout << "Creating file " << itsFilename << std::endl;
+    itsFd = ::open(itsFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | flags, 0644);
+    if (itsFd < 0) {
+        throw std::runtime_error(itsFilename + ": open: " + strerror(errno));
+    }
+}
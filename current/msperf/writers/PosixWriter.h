@@ -0,0 +1,65 @@
+/// @file PosixWriter.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef POSIXWRITER_H
+#define POSIXWRITER_H
+
+// System includes
+#include <string>
+
+// ASKAPsoft includes
+#include "Common/ParameterSet.h"
+
+// Local includes
+#include "IWriter.h"
+
+/// Writes each integration record to a flat file with write(2), through the
+/// page cache. With "sync = true" each integration is followed by
+/// fdatasync(2).
+class PosixWriter : public IWriter
+{
+    public:
+        PosixWriter(const std::string& filename, const LOFAR::ParameterSet& parset);
+        virtual ~PosixWriter();
+
+        virtual void add(const Integration& integration);
+        virtual std::string name(void) const;
+
+    protected:
+        /// For derived backends that need extra open(2) flags
+        PosixWriter(const std::string& filename, const LOFAR::ParameterSet& parset,
+                int flags);
+
+        /// Write the whole buffer, retrying short writes
+        void writeFully(const char* buf, size_t n);
+
+        std::string itsFilename;
+        int itsFd;
+        bool itsSync;
+
+    private:
+        void open(int flags);
+};
+
+#endif
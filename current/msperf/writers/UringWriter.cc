@@ -0,0 +1,126 @@
+/// @file UringWriter.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifdef HAVE_LIBURING
+
+// Include own header file first
+#include "UringWriter.h"
+
+// System includes
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+UringWriter::UringWriter(const std::string& filename, const LOFAR::ParameterSet& parset)
+: itsFilename(filename),
+    itsDepth(parset.getInt32("uring.depth", 8)),
+    itsChunkSize(parset.getInt32("uring.chunksize", 1048576)),
+    itsDirect(parset.getBool("uring.direct", false)),
+    itsFd(-1), itsOffset(0)
+{
+    // Chunks must stay aligned for O_DIRECT
+    itsChunkSize = (itsChunkSize + Integration::alignment - 1)
+        / Integration::alignment * Integration::alignment;
+
+    std::cout << "Creating file " << itsFilename << std::endl;
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | (itsDirect ? O_DIRECT : 0);
+    itsFd = open(itsFilename.c_str(), flags, 0644);
+    if (itsFd < 0) {
+        throw std::runtime_error(itsFilename + ": open: " + strerror(errno));
+    }
+
+    const int status = io_uring_queue_init(itsDepth, &itsRing, 0);
+    if (status < 0) {
+        close(itsFd);
+        throw std::runtime_error("io_uring_queue_init: " + std::string(strerror(-status)));
+    }
+}
+
+UringWriter::~UringWriter()
+{
+    io_uring_queue_exit(&itsRing);
+    close(itsFd);
+}
+
+void UringWriter::add(const Integration& integration)
+{
+    const char* buf = integration.data();
+    const size_t size = integration.size();
+    size_t queued = 0;
+    unsigned int inflight = 0;
+
+    while (queued < size || inflight > 0) {
+        // Top up the submission queue
+        while (inflight < itsDepth && queued < size) {
+            struct io_uring_sqe* sqe = io_uring_get_sqe(&itsRing);
+            if (!sqe) {
+                break;
+            }
+            const size_t len = std::min(itsChunkSize, size - queued);
+            io_uring_prep_write(sqe, itsFd, buf + queued, len, itsOffset + queued);
+            io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(len));
+            queued += len;
+            inflight++;
+        }
+        io_uring_submit(&itsRing);
+
+        // Reap one completion
+        struct io_uring_cqe* cqe = 0;
+        const int status = io_uring_wait_cqe(&itsRing, &cqe);
+        if (status < 0) {
+            throw std::runtime_error("io_uring_wait_cqe: " + std::string(strerror(-status)));
+        }
+        const int res = cqe->res;
+        const size_t len = reinterpret_cast<size_t>(io_uring_cqe_get_data(cqe));
+        io_uring_cqe_seen(&itsRing, cqe);
+        inflight--;
+
+        if (res < 0) {
+            throw std::runtime_error(itsFilename + ": write: " + strerror(-res));
+        }
+        if (static_cast<size_t>(res) != len) {
+            std::ostringstream ss;
+            ss << itsFilename << ": short write of " << res << " of " << len << " bytes";
+            throw std::runtime_error(ss.str());
+        }
+    }
+
+    itsOffset += size;
+}
+
+std::string UringWriter::name(void) const
+{
+    std::ostringstream ss;
+    ss << "io_uring (depth " << itsDepth << ", " << itsChunkSize << " byte writes"
+        << (itsDirect ? ", O_DIRECT)" : ")");
+    return ss.str();
+}
+
+#endif // HAVE_LIBURING
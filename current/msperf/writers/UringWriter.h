@@ -0,0 +1,65 @@
+/// @file UringWriter.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef URINGWRITER_H
+#define URINGWRITER_H
+
+#ifdef HAVE_LIBURING
+
+// System includes
+#include <string>
+#include <sys/types.h>
+#include <liburing.h>
+
+// ASKAPsoft includes
+#include "Common/ParameterSet.h"
+
+// Local includes
+#include "IWriter.h"
+
+/// Splits each integration record into "uring.chunksize" byte writes and
+/// keeps up to "uring.depth" of them queued on an io_uring. With
+/// "uring.direct = true" the file is opened with O_DIRECT.
+class UringWriter : public IWriter
+{
+    public:
+        UringWriter(const std::string& filename, const LOFAR::ParameterSet& parset);
+        virtual ~UringWriter();
+
+        virtual void add(const Integration& integration);
+        virtual std::string name(void) const;
+
+    private:
+        std::string itsFilename;
+        unsigned int itsDepth;
+        size_t itsChunkSize;
+        bool itsDirect;
+        int itsFd;
+        off_t itsOffset;
+        struct io_uring itsRing;
+};
+
+#endif // HAVE_LIBURING
+
+#endif
@@ -0,0 +1,65 @@
+/// @file WriterFactory.cc
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "WriterFactory.h"
+
+// System includes
+#include <string>
+#include <iostream>
+
+// Local includes
+#include "DataSet.h"
+#include "PosixWriter.h"
+#include "DirectWriter.h"
+#include "MmapWriter.h"
+#include "CompressingWriter.h"
+#include "UringWriter.h"
+
+IWriter* WriterFactory::create(const std::string& filename,
+        const LOFAR::ParameterSet& parset)
+{
+    const std::string writer = parset.getString("writer", "ms");
+
+    if (writer == "posix") {
+        return new PosixWriter(filename, parset);
+    } else if (writer == "direct") {
+        return new DirectWriter(filename, parset);
+    } else if (writer == "mmap") {
+        return new MmapWriter(filename, parset);
+    } else if (writer == "compress") {
+        return new CompressingWriter(filename, parset);
+    } else if (writer == "uring") {
+#ifdef HAVE_LIBURING
+        return new UringWriter(filename, parset);
+#else
+        std::cerr << "Built without liburing, using posix writer" << std::endl;
+        return new PosixWriter(filename, parset);
+#endif
+    } else if (writer != "ms") {
+        std::cerr << "Unknown writer " << writer << ", using ms" << std::endl;
+    }
+
+    return new DataSet(filename, parset);
+}
@@ -0,0 +1,47 @@
+/// @file WriterFactory.h
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+#ifndef WRITERFACTORY_H
+#define WRITERFACTORY_H
+
+// System includes
+#include <string>
+
+// ASKAPsoft includes
+#include "Common/ParameterSet.h"
+
+// Local includes
+#include "IWriter.h"
+
+class WriterFactory
+{
+    public:
+        /// Create the backend named by the "writer" parameter: "ms" (the
+        /// default, a casacore measurement set), "posix", "direct", "mmap",
+        /// "uring" or "compress". The caller owns the returned writer.
+        static IWriter* create(const std::string& filename,
+                const LOFAR::ParameterSet& parset);
+};
+
+#endif
@@ -26,6 +26,8 @@
 
 // Include own header file first
 #include "Benchmark.h"
+#include "Trace.h"
+#include "ASKAPLayout.h"
 
 // System includes
 #include <stdlib.h>
@@ -66,6 +68,7 @@ int Benchmark::randomInt()
 
 void Benchmark::init()
 {
+    TraceScope ts("init", "init");
 
     // Initialize constants
     const Coord obslen = 12.;               // Observation length in hours
@@ -83,7 +86,7 @@ void Benchmark::init()
     Real imgExt;                            // image extension factor: 1~FWHM, 2~first null, 4~second null
 
     int wkernel = 0;                        // just a trigger to print more info when w-kernels are used
-    Real wmax, fov;
+    Real wmax = 0.0, fov = 0.0;
     // for du and dw to have a similar effect on DR, arXiv:1207.586 gives dw ~ du * 2 / FoV
     // or equivalenty, both should have their natural resolution divided by the same oversampling factor
     // or equivalenty, both should have the same number of pixels in the cached gridding cube
@@ -173,57 +176,11 @@ void Benchmark::init()
 
     // observation coordinates (26.6970° S, 116.6311° E)
     // set dec to obs lat and ha to +/- 6 hours
-    Coord lat = -26.6970 * 3.141593/180.0;
-    Coord dec = lat;
-    const Coord cdec = cos(dec);
-    const Coord sdec = sin(dec);
-
-    const int nAntennas = 36;
-    const int nBaselinesMax = (nAntennas*(nAntennas-1))/2;
-
-    static const Coord east[]  = {  -42.43847222,   -15.46047222,    -6.48847222,   -51.41747222,
-                                   -116.43047222,    93.22152778,   200.42152778,   -80.24847222,
-                                   -286.64847222,  -138.75447222,   225.51252778,   353.48652778,
-                                    396.28152778,   -67.29847222,  -782.13847222,  -678.55347222,
-                                   -539.25647222,  -149.22347222,   175.37552778,   463.88152778,
-                                    643.72952778,   803.40152778,   -43.14647222,    36.03352778,
-                                   -656.05547222,  -435.77447222, -1112.94147222,   207.32652778,
-                                    523.49152778,  1186.61752778,  2178.51052778,  2982.48652778,
-                                    -17.41247222, -3017.44747222, -2213.43647222,   -19.20647222};
-    static const Coord north[] = { -105.22933333,  -118.24033333,   -97.73933333,   -70.22133333,
-                                    -73.72633333,     6.77066667,  -215.20933333,  -343.73933333,
-                                      5.32066667,   174.26666667,   235.30966667,   164.24666667,
-                                   -469.23433333,  -565.23833333,  -263.22233333,   260.21066667,
-                                    417.28966667,   270.27966667,   376.29066667,   209.79766667,
-                                    216.77666667,   230.75266667,  -762.23633333, -1083.75233333,
-                                    548.27766667,   562.27366667,   835.74566667,  1093.28166667,
-                                    647.98066667,   693.23866667,   887.75566667, -2612.27533333,
-                                  -2916.19433333, -2112.20733333,   887.76166667,  3084.83866667};
-    std::vector<Coord> E (east, east + sizeof(east) / sizeof(east[0]) );
-    std::vector<Coord> N (north, north + sizeof(north) / sizeof(north[0]) );
-    std::vector<Coord> X(nAntennas), Y(nAntennas), Z(nAntennas);
-    std::vector<Coord> BX(nBaselinesMax), BY(nBaselinesMax), BZ(nBaselinesMax);
-
-    for (int i = 0; i < nAntennas; i++) {
-        X[i] = -N[i]*sin(lat);
-        Y[i] =  E[i];
-        Z[i] =  N[i]*cos(lat);
-    }
-    int bl = 0;
-    for (int i = 0; i < nAntennas-1; i++) {
-        for (int j = i+1; j < nAntennas; j++) {
-            Coord dX = X[i] - X[j];
-            Coord dY = Y[i] - Y[j];
-            Coord dZ = Z[i] - Z[j];
-            if (dX*dX + dY*dY + dZ*dZ > baseline*baseline) continue;
-            BX[bl] = dX;
-            BY[bl] = dY;
-            BZ[bl] = dZ;
-            bl++;
-        }
-    }
+    const Coord dec = ASKAPLayout::latitude();
 
-    const int nBaselines = bl;
+    const ASKAPLayout layout(baseline);
+
+    const int nBaselines = layout.nBaselines();
     nSamples = nScans*nBaselines;           // Number of data samples per channel, polarisation & beam
 
     // Initialize the data to be gridded
@@ -248,11 +205,7 @@ void Benchmark::init()
     for (int i = 0; i < nSamples; i++) {
         const int bl = nBaselines * (Coord(randomInt()) / Coord(maxint));
         const Coord ha = obslen * 3.141593/12.0 * ((Coord(randomInt()) / Coord(maxint)) - 0.5);
-        const Coord cha = cos(ha);
-        const Coord sha = sin(ha);
-        u[i] =       sha*BX[bl] +      cha*BY[bl];
-        v[i] = -sdec*cha*BX[bl] + sdec*sha*BY[bl] + cdec*BZ[bl];
-        w[i] =  cdec*cha*BX[bl] - cdec*sha*BY[bl] + sdec*BZ[bl];
+        layout.uvw(bl, ha, dec, u[i], v[i], w[i]);
 
         for (int chan = 0; chan < nChan; chan++) {
             data[i*nChan+chan] = 1.0;
@@ -273,8 +226,14 @@ void Benchmark::init()
     }
 
     // Initialize convolution function and offsets
-    initC(uvCellSize, wSize, m_support, overSample, wCellSize, C);
-    initCOffset(u, v, w, wavenumber, uvCellSize, wCellSize, wSize, gSize, overSample);
+    {
+        TraceScope ts("initC", "init");
+        initC(uvCellSize, wSize, m_support, overSample, wCellSize, C);
+    }
+    {
+        TraceScope ts("initCOffset", "init");
+        initCOffset(u, v, w, wavenumber, uvCellSize, wCellSize, wSize, gSize, overSample);
+    }
 
     if ( (doSort==1) && (wSize>1) ) {
         // sort based on w-plane but without consideration of order within
@@ -303,26 +262,31 @@ void Benchmark::init()
 
 void Benchmark::runGrid()
 {
+    TraceScope ts("grid", "cpu");
     gridKernel(C, grid1, gSize);
 }
 
 void Benchmark::runGridACC()
 {
+    TraceScope ts("grid", "acc");
     gridKernelACC(C, grid2, gSize);
 }
 
 void Benchmark::runDegrid()
 {
+    TraceScope ts("degrid", "cpu");
     degridKernel(grid1, gSize, C, outdata1);
 }
 
 void Benchmark::runDegridACC()
 {
+    TraceScope ts("degrid", "acc");
     degridKernelACC(grid2, gSize, C, outdata2);
 }
 
 void Benchmark::runGridCheck()
 {
+    TraceScope ts("grid check", "verify");
     double sum1 = 0.0;
     double sum2 = 0.0;
     for (int i = 0; i < int(grid1.size()); i++) {
@@ -344,6 +308,7 @@ void Benchmark::runGridCheck()
 
 void Benchmark::runDegridCheck()
 {
+    TraceScope ts("degrid check", "verify");
     double sum1 = 0.0;
     double sum2 = 0.0;
     for (int i = 0; i < int(outdata1.size()); i++) {
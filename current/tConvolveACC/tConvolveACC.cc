@@ -48,11 +48,15 @@
 // Local includes
 #include "Benchmark.h"
 #include "Stopwatch.h"
+#include "Trace.h"
 
 // Main testing routine
 int main(int argc, char *argv[])
 {
 
+    // Timeline tracing is enabled by setting ASKAP_TRACE to an output file name
+    Trace::init();
+
     // Setup the benchmark class
     Benchmark bmark;
 
@@ -30,6 +30,8 @@
 #include <vector>
 #include <complex>
 
+class MemoryUsage;
+
 // Typedefs
 typedef double Coord;
 typedef float Real;
@@ -66,6 +68,9 @@ class Benchmark {
         long nPixelsGridded();
         std::vector<float> requiredRate();
 
+        /// Record the size of the main data structures.
+        void addMemoryUsage(MemoryUsage& mem) const;
+
         void setMPIrank(const int rank) {mpirank = rank;}
         void setSort(const int type) {doSort = type;}
         void setRunType(const int type) {runType = type;}
@@ -0,0 +1,96 @@
+/// @copyright (c) 2017 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @detail
+/// Memory instrumentation for the benchmarks:
+///  - resident set size from /proc/self/status. Stage peaks are found by
+///    resetting the kernel's high water mark (VmHWM) at the start of a stage
+///    via /proc/self/clear_refs; where that is not permitted the reported
+///    peak is the process peak up to the end of the stage.
+///  - bytes allocated through C++ operator new. Linking MemoryUsage.o
+///    replaces the global operator new and delete with counting versions.
+///    Memory from malloc, MPI or the OpenACC runtime is not included.
+///  - the size of each named data structure, as recorded by the caller.
+
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+
+// System includes
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+
+class MemoryUsage {
+    public:
+        MemoryUsage();
+
+        /// Current resident set size in bytes (VmRSS), 0 if unavailable.
+        static size_t currentRSS();
+
+        /// Peak resident set size in bytes (VmHWM), 0 if unavailable.
+        static size_t peakRSS();
+
+        /// Reset the peak resident set size. Returns false if not supported.
+        static bool resetPeakRSS();
+
+        /// Bytes currently allocated through operator new.
+        static size_t heapBytes();
+
+        /// Largest value heapBytes() has reached.
+        static size_t peakHeapBytes();
+
+        /// Number of calls to operator new.
+        static size_t heapAllocations();
+
+        /// Restart the heap peak and allocation count from the current state.
+        static void resetHeapCounters();
+
+        void beginStage();
+        void endStage(const std::string& name);
+
+        /// Record the size of a data structure. Sizes for the same name add up.
+        void addStructure(const std::string& name, const size_t bytes);
+
+        template <typename T>
+        void addStructure(const std::string& name, const std::vector<T>& vec)
+        {
+            addStructure(name, vec.capacity() * sizeof(T));
+        }
+
+        /// The values shown by report(), in bytes, in the same order. Used
+        /// to combine results across MPI processes.
+        void summary(std::vector<std::string>& labels, std::vector<double>& bytes) const;
+
+        /// Print the peak RSS and heap, the recorded data structures and
+        /// the largest peak seen for each stage, in order of first use.
+        void report(std::ostream& os) const;
+
+    private:
+        std::vector<std::string> m_names;
+        std::vector<size_t> m_peaks;
+        std::vector<std::string> m_structNames;
+        std::vector<size_t> m_structBytes;
+        bool m_resetWorks;
+};
+
+#endif
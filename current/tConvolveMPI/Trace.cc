@@ -0,0 +1,189 @@
+/// @copyright (c) 2017 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "Trace.h"
+
+// System includes
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <mutex>
+
+namespace {
+
+// Events per thread. Once full, further events are counted but dropped.
+const size_t kBufferCapacity = 1 << 16;
+
+struct Event {
+    const char* name;
+    const char* cat;
+    uint64_t start;
+    uint64_t dur;
+};
+
+struct Buffer {
+    std::vector<Event> events;
+    size_t count;
+    size_t dropped;
+    int tid;
+};
+
+std::mutex s_mutex;
+std::vector<Buffer*> s_buffers;
+std::string s_filename;
+int s_pid = 0;
+uint64_t s_origin = 0;
+bool s_flushed = false;
+
+thread_local Buffer* t_buffer = 0;
+
+// Registration is the only locked operation and happens once per thread
+Buffer* threadBuffer()
+{
+    if (t_buffer == 0) {
+        Buffer* b = new Buffer;
+        b->events.resize(kBufferCapacity);
+        b->count = 0;
+        b->dropped = 0;
+        std::lock_guard<std::mutex> lock(s_mutex);
+        b->tid = s_buffers.size();
+        s_buffers.push_back(b);
+        t_buffer = b;
+    }
+    return t_buffer;
+}
+
+void flushAtExit()
+{
+    Trace::flush();
+}
+
+}
+
+bool Trace::s_enabled = false;
+
+void Trace::init(const int pid)
+{
+    const char* env = getenv("ASKAP_TRACE");
+    if (env != 0) {
+        init(std::string(env), pid);
+    }
+}
+
+void Trace::init(const std::string& filename, const int pid)
+{
+    if (filename.empty() || s_enabled) {
+        return;
+    }
+
+    s_filename = filename;
+    const std::string pattern = "%w";
+    const size_t pos = s_filename.find(pattern);
+    if (pos != std::string::npos) {
+        std::ostringstream oss;
+        oss << pid;
+        s_filename.replace(pos, pattern.length(), oss.str());
+    }
+
+    s_pid = pid;
+    s_origin = now();
+    s_enabled = true;
+
+    // Allocate the calling thread's buffer up front, outside any timed region
+    threadBuffer();
+    atexit(flushAtExit);
+}
+
+uint64_t Trace::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ULL + uint64_t(ts.tv_nsec);
+}
+
+void Trace::complete(const char* name, const char* cat, const uint64_t start)
+{
+    if (!s_enabled) {
+        return;
+    }
+    const uint64_t stop = now();
+    Buffer* b = threadBuffer();
+    if (b->count < kBufferCapacity) {
+        Event& e = b->events[b->count++];
+        e.name = name;
+        e.cat = cat;
+        e.start = start;
+        e.dur = stop - start;
+    } else {
+        b->dropped++;
+    }
+}
+
+void Trace::flush()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_enabled || s_flushed) {
+        return;
+    }
+    s_flushed = true;
+
+    std::ofstream file(s_filename.c_str(), std::ios::out | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Trace: could not open " << s_filename << std::endl;
+        return;
+    }
+
+    // Timestamps are in microseconds relative to Trace::init()
+    file.setf(std::ios::fixed);
+    file.precision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << '\n';
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << s_pid
+         << ",\"args\":{\"name\":\"rank " << s_pid << "\"}}";
+
+    size_t nEvents = 0;
+    size_t nDropped = 0;
+    for (size_t t = 0; t < s_buffers.size(); ++t) {
+        const Buffer* b = s_buffers[t];
+        for (size_t i = 0; i < b->count; ++i) {
+            const Event& e = b->events[i];
+            const uint64_t start = e.start > s_origin ? e.start - s_origin : 0;
+            file << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"" << e.cat
+                 << "\",\"ph\":\"X\",\"ts\":" << double(start) / 1e3
+                 << ",\"dur\":" << double(e.dur) / 1e3
+                 << ",\"pid\":" << s_pid << ",\"tid\":" << b->tid << "}";
+        }
+        nEvents += b->count;
+        nDropped += b->dropped;
+    }
+    file << "\n]}" << std::endl;
+    file.close();
+
+    std::cout << "Trace: wrote " << nEvents << " events to " << s_filename;
+    if (nDropped > 0) {
+        std::cout << " (" << nDropped << " dropped, buffer full)";
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,82 @@
+/// @copyright (c) 2017 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @detail
+/// Timeline tracing in the Chrome trace event format. Each thread records
+/// complete ("X") events into its own preallocated buffer, so recording an
+/// event takes no locks. All buffers are written out as a single JSON file
+/// when the program exits; load it in chrome://tracing or ui.perfetto.dev.
+///
+/// Tracing is off unless the ASKAP_TRACE environment variable names an
+/// output file. A "%w" in the name is replaced by the process id passed to
+/// Trace::init() (the MPI rank, for example).
+///
+/// Event names and categories must be string literals (or otherwise outlive
+/// the program), as only the pointers are stored.
+
+#ifndef TRACE_H
+#define TRACE_H
+
+// System includes
+#include <string>
+#include <stdint.h>
+
+class Trace {
+    public:
+        /// Enable tracing if ASKAP_TRACE is set. pid labels this process.
+        static void init(const int pid = 0);
+
+        /// Enable tracing to the given file (no-op if filename is empty).
+        static void init(const std::string& filename, const int pid = 0);
+
+        static bool enabled() { return s_enabled; }
+
+        /// Monotonic time in nanoseconds.
+        static uint64_t now();
+
+        /// Record an event that started at start and ended now (no-op if disabled).
+        static void complete(const char* name, const char* cat, const uint64_t start);
+
+        /// Write all recorded events. Called automatically at exit.
+        static void flush();
+
+    private:
+        static bool s_enabled;
+};
+
+/// Records an event covering the lifetime of the object.
+class TraceScope {
+    public:
+        TraceScope(const char* name, const char* cat)
+            : m_name(name), m_cat(cat), m_start(Trace::enabled() ? Trace::now() : 0) {}
+
+        ~TraceScope() {
+            Trace::complete(m_name, m_cat, m_start);
+        }
+
+    private:
+        const char* m_name;
+        const char* m_cat;
+        uint64_t m_start;
+};
+
+#endif
@@ -43,6 +43,8 @@
 
 // System & MPI includes
 #include <iostream>
+#include <string>
+#include <vector>
 #include <mpi.h>
 
 // BLAS includes
@@ -58,6 +60,36 @@
 // Local includes
 #include "Benchmark.h"
 #include "Stopwatch.h"
+#include "Trace.h"
+#include "MemoryUsage.h"
+
+// Report memory use as the largest value on any process and the total
+// over all processes (master reports only)
+void reportMemory(const MemoryUsage& mem, const int rank, const int numtasks)
+{
+    std::vector<std::string> labels;
+    std::vector<double> bytes;
+    mem.summary(labels, bytes);
+
+    const int n = bytes.size();
+    std::vector<double> maxBytes(n);
+    std::vector<double> sumBytes(n);
+    MPI_Reduce(&bytes[0], &maxBytes[0], n, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&bytes[0], &sumBytes[0], n, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    double allocs = double(MemoryUsage::heapAllocations());
+    double maxAllocs = 0.0;
+    MPI_Reduce(&allocs, &maxAllocs, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        const double MB = 1024.0 * 1024.0;
+        std::cout << "  Memory (largest per process, total over " << numtasks << " processes)" << std::endl;
+        for (int i = 0; i < n; ++i) {
+            std::cout << "    " << labels[i] << " " << maxBytes[i] / MB << " (MB), "
+                      << sumBytes[i] / MB << " (MB)" << std::endl;
+        }
+        std::cout << "    Heap allocations " << maxAllocs << std::endl;
+    }
+}
 
 // Main testing routine
 int main(int argc, char *argv[])
@@ -75,6 +107,10 @@ int main(int argc, char *argv[])
     int rank;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
 
+    // Timeline tracing is enabled by setting ASKAP_TRACE to an output file
+    // name. Include %w in the name to get one trace file per rank.
+    Trace::init(rank);
+
     // Setup the benchmark class
     Benchmark bmark;
 
@@ -96,7 +132,11 @@ int main(int argc, char *argv[])
             std::cout << "+++++ Test "<<bmark.getRunType()<<" +++++" << std::endl;
         }
 
+        MemoryUsage mem;
+        MemoryUsage::resetHeapCounters();
+        mem.beginStage();
         bmark.init();
+        mem.endStage("init");
 
         Stopwatch sw;
         double time;
@@ -106,11 +146,16 @@ int main(int argc, char *argv[])
         const double ngridpix = double(bmark.nPixelsGridded());
         const double tgridpix = ngridpix * double(numtasks);
  
+        mem.beginStage();
         MPI_Barrier(MPI_COMM_WORLD);
         sw.start();
         bmark.runGrid();
-        MPI_Barrier(MPI_COMM_WORLD);
+        {
+            TraceScope ts("barrier", "mpi");
+            MPI_Barrier(MPI_COMM_WORLD);
+        }
         time = sw.stop();
+        mem.endStage("grid");
  
         // Report on timings (master reports only)
         if (rank == 0) {
@@ -142,11 +187,16 @@ int main(int argc, char *argv[])
         }
         */
 
+        mem.beginStage();
         MPI_Barrier(MPI_COMM_WORLD);
         sw.start();
         bmark.runDegrid();
-        MPI_Barrier(MPI_COMM_WORLD);
+        {
+            TraceScope ts("barrier", "mpi");
+            MPI_Barrier(MPI_COMM_WORLD);
+        }
         time = sw.stop();
+        mem.endStage("degrid");
  
         // Report on timings (master reports only)
         if (rank == 0) {
@@ -178,6 +228,9 @@ int main(int argc, char *argv[])
         }
         */
 
+        bmark.addMemoryUsage(mem);
+        reportMemory(mem, rank, numtasks);
+
         if (rank == 0) {
             std::cout << "Done" << std::endl;
         }
@@ -37,6 +37,7 @@
 // Local includes
 #include "Parameters.h"
 #include "Stopwatch.h"
+#include "MemoryUsage.h"
 #include "HogbomGolden.h"
 #include "HogbomACC.h"
 
@@ -117,6 +118,8 @@ int main(int /*argc*/, char** /* argv*/)
     // Reports some numbers
     cout << "Iterations = " << g_niters << endl;
     cout << "Image dimensions = " << dim << "x" << dim << endl;
+
+    MemoryUsage mem;
     //
     // Run the golden version of the code
     //
@@ -128,10 +131,12 @@ int main(int /*argc*/, char** /* argv*/)
         cout << "+++++ Forward processing (CPU Golden) +++++" << endl;
         HogbomGolden golden;
 
+        mem.beginStage();
         Stopwatch sw;
         sw.start();
         golden.deconvolve(dirty, dim, psf, psfDim, goldenModel, goldenResidual);
         time1 = sw.stop();
+        mem.endStage("golden");
 
         // Report on timings
         cout << "    Time " << time1 << " (s) " << endl;
@@ -155,10 +160,12 @@ int main(int /*argc*/, char** /* argv*/)
         cout << "+++++ Forward processing (OpenACC) +++++" << endl;
         HogbomACC acc;
 
+        mem.beginStage();
         Stopwatch sw;
         sw.start();
         acc.deconvolve(dirty, dim, psf, psfDim, accModel, accResidual);
         time2 = sw.stop();
+        mem.endStage("openacc");
 
         // Report on timings
         cout << "    Time " << time2 << " (s) " << endl;
@@ -167,6 +174,14 @@ int main(int /*argc*/, char** /* argv*/)
         cout << "Done" << endl;
     }
 
+    mem.addStructure("images", dirty);
+    mem.addStructure("images", psf);
+    mem.addStructure("golden results", goldenModel);
+    mem.addStructure("golden results", goldenResidual);
+    mem.addStructure("OpenACC results", accModel);
+    mem.addStructure("OpenACC results", accResidual);
+    mem.report(cout);
+
     cout << "Verifying model...";
     const bool modelDiff = compare(goldenModel, accModel);
     if (!modelDiff) {
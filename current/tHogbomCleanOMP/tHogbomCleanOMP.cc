@@ -37,6 +37,7 @@
 // Local includes
 #include "Parameters.h"
 #include "Stopwatch.h"
+#include "MemoryUsage.h"
 #include "HogbomGolden.h"
 #include "HogbomOMP.h"
 
@@ -114,6 +115,8 @@ int main(int /*argc*/, char** /* argv*/)
     // Reports some numbers
     cout << "Iterations = " << g_niters << endl;
     cout << "Image dimensions = " << dim << "x" << dim << endl;
+
+    MemoryUsage mem;
     //
     // Run the golden version of the code
     //
@@ -126,10 +129,12 @@ int main(int /*argc*/, char** /* argv*/)
         cout << "+++++ Forward processing (CPU Golden) +++++" << endl;
         HogbomGolden golden;
 
+        mem.beginStage();
         Stopwatch sw;
         sw.start();
         golden.deconvolve(dirty, dim, psf, psfDim, goldenModel, goldenResidual);
         time0 = sw.stop();
+        mem.endStage("golden");
 
         // Report on timings
         cout << "    Time " << time0 << " (s) " << endl;
@@ -153,10 +158,12 @@ int main(int /*argc*/, char** /* argv*/)
         cout << "+++++ Forward processing (OpenMP) +++++" << endl;
         HogbomOMP omp;
 
+        mem.beginStage();
         Stopwatch sw;
         sw.start();
         omp.deconvolve(dirty, dim, psf, psfDim, ompModel, ompResidual);
         const double time = sw.stop();
+        mem.endStage("openmp");
 
         // Report on timings
         cout << "    Time " << time << " (s) " << endl;
@@ -166,6 +173,14 @@ int main(int /*argc*/, char** /* argv*/)
         cout << "Done" << endl;
     }
 
+    mem.addStructure("images", dirty);
+    mem.addStructure("images", psf);
+    mem.addStructure("golden results", goldenModel);
+    mem.addStructure("golden results", goldenResidual);
+    mem.addStructure("OpenMP results", ompModel);
+    mem.addStructure("OpenMP results", ompResidual);
+    mem.report(cout);
+
     cout << "Verifying model...";
     const bool modelDiff = compare(goldenModel, ompModel);
     if (!modelDiff) {
@@ -0,0 +1,96 @@
+/// @copyright (c) 2017 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+
+// Include own header file first
+#include "ASKAPLayout.h"
+
+// System includes
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+const double east[]  = {  -42.43847222,   -15.46047222,    -6.48847222,   -51.41747222,
+                         -116.43047222,    93.22152778,   200.42152778,   -80.24847222,
+                         -286.64847222,  -138.75447222,   225.51252778,   353.48652778,
+                          396.28152778,   -67.29847222,  -782.13847222,  -678.55347222,
+                         -539.25647222,  -149.22347222,   175.37552778,   463.88152778,
+                          643.72952778,   803.40152778,   -43.14647222,    36.03352778,
+                         -656.05547222,  -435.77447222, -1112.94147222,   207.32652778,
+                          523.49152778,  1186.61752778,  2178.51052778,  2982.48652778,
+                          -17.41247222, -3017.44747222, -2213.43647222,   -19.20647222};
+const double north[] = { -105.22933333,  -118.24033333,   -97.73933333,   -70.22133333,
+                          -73.72633333,     6.77066667,  -215.20933333,  -343.73933333,
+                            5.32066667,   174.26666667,   235.30966667,   164.24666667,
+                         -469.23433333,  -565.23833333,  -263.22233333,   260.21066667,
+                          417.28966667,   270.27966667,   376.29066667,   209.79766667,
+                          216.77666667,   230.75266667,  -762.23633333, -1083.75233333,
+                          548.27766667,   562.27366667,   835.74566667,  1093.28166667,
+                          647.98066667,   693.23866667,   887.75566667, -2612.27533333,
+                        -2916.19433333, -2112.20733333,   887.76166667,  3084.83866667};
+
+}
+
+ASKAPLayout::ASKAPLayout(const double maxBaseline)
+    : m_longest(0.0)
+{
+    const double lat = latitude();
+
+    std::vector<double> X(nAntennas), Y(nAntennas), Z(nAntennas);
+    for (int i = 0; i < nAntennas; i++) {
+        X[i] = -north[i]*sin(lat);
+        Y[i] =  east[i];
+        Z[i] =  north[i]*cos(lat);
+    }
+
+    for (int i = 0; i < nAntennas-1; i++) {
+        for (int j = i+1; j < nAntennas; j++) {
+            const double dX = X[i] - X[j];
+            const double dY = Y[i] - Y[j];
+            const double dZ = Z[i] - Z[j];
+            const double length2 = dX*dX + dY*dY + dZ*dZ;
+            if (length2 > maxBaseline*maxBaseline) continue;
+            m_bx.push_back(dX);
+            m_by.push_back(dY);
+            m_bz.push_back(dZ);
+            m_longest = std::max(m_longest, sqrt(length2));
+        }
+    }
+}
+
+double ASKAPLayout::latitude()
+{
+    return -26.6970 * 3.141593/180.0;
+}
+
+void ASKAPLayout::uvw(const int bl, const double ha, const double dec,
+                      double& u, double& v, double& w) const
+{
+    const double cha = cos(ha);
+    const double sha = sin(ha);
+    const double cdec = cos(dec);
+    const double sdec = sin(dec);
+    u =       sha*m_bx[bl] +      cha*m_by[bl];
+    v = -sdec*cha*m_bx[bl] + sdec*sha*m_by[bl] + cdec*m_bz[bl];
+    w =  cdec*cha*m_bx[bl] - cdec*sha*m_by[bl] + sdec*m_bz[bl];
+}
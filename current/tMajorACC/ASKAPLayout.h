@@ -0,0 +1,65 @@
+/// @copyright (c) 2017 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+///
+/// @detail
+/// Baselines of the 36 antenna ASKAP array and their uvw tracks. Antenna
+/// positions are east/north offsets in metres from the array centre at the
+/// Murchison Radio-astronomy Observatory (26.6970 deg S). Used by the
+/// benchmarks to generate uvw samples with the access pattern of real data
+/// rather than uniformly at random.
+
+#ifndef ASKAPLAYOUT_H
+#define ASKAPLAYOUT_H
+
+// System includes
+#include <vector>
+
+class ASKAPLayout {
+    public:
+        /// Use all baselines no longer than maxBaseline metres.
+        ASKAPLayout(const double maxBaseline);
+
+        static const int nAntennas = 36;
+
+        /// Array latitude in radians.
+        static double latitude();
+
+        int nBaselines() const { return m_bx.size(); }
+
+        /// Longest baseline in use, in metres.
+        double longestBaseline() const { return m_longest; }
+
+        /// uvw in metres of baseline bl at hour angle ha, for a source at
+        /// declination dec (both in radians).
+        void uvw(const int bl, const double ha, const double dec,
+                 double& u, double& v, double& w) const;
+
+    private:
+        // Baseline vectors in the equatorial (X,Y,Z) frame
+        std::vector<double> m_bx;
+        std::vector<double> m_by;
+        std::vector<double> m_bz;
+        double m_longest;
+};
+
+#endif
@@ -0,0 +1,77 @@
+/// @copyright (c) 2017 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "GridPool.h"
+
+// System includes
+#include <algorithm>
+#include <stdexcept>
+
+GridPool::GridPool(const size_t nPixels)
+    : m_nPixels(nPixels), m_reuses(0), m_inUse(0), m_peakInUse(0)
+{
+}
+
+GridPool::~GridPool()
+{
+    for (size_t i = 0; i < m_all.size(); ++i) {
+        delete m_all[i];
+    }
+}
+
+GridPool::Grid& GridPool::acquire(const bool zero)
+{
+    Grid* grid;
+    if (m_free.empty()) {
+        grid = new Grid(m_nPixels);
+        m_all.push_back(grid);
+    } else {
+        grid = m_free.back();
+        m_free.pop_back();
+        m_reuses++;
+        if (zero) {
+            grid->assign(m_nPixels, std::complex<float>(0.0));
+        }
+    }
+
+    m_inUse++;
+    m_peakInUse = std::max(m_peakInUse, m_inUse);
+
+    return *grid;
+}
+
+void GridPool::release(Grid& grid)
+{
+    if (std::find(m_all.begin(), m_all.end(), &grid) == m_all.end()) {
+        throw std::runtime_error("GridPool: released grid not owned by this pool");
+    }
+    if (std::find(m_free.begin(), m_free.end(), &grid) != m_free.end()) {
+        throw std::runtime_error("GridPool: grid released twice");
+    }
+    if (grid.size() != m_nPixels) {
+        throw std::runtime_error("GridPool: released grid has been resized");
+    }
+
+    m_free.push_back(&grid);
+    m_inUse--;
+}
@@ -0,0 +1,71 @@
+/// @copyright (c) 2017 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @detail
+/// A pool of equally sized complex grids. Grids that are released go on a
+/// free list and are handed out again by the next acquire(), so scratch
+/// grids are allocated once for the whole run rather than once per major
+/// cycle. The pool owns the grids; references stay valid until it is
+/// destroyed.
+
+#ifndef GRIDPOOL_H
+#define GRIDPOOL_H
+
+// System includes
+#include <vector>
+#include <complex>
+#include <cstddef>
+
+class GridPool {
+    public:
+        typedef std::vector<std::complex<float> > Grid;
+
+        GridPool(const size_t nPixels);
+        ~GridPool();
+
+        /// Get a grid, reusing a released one if possible. The contents are
+        /// undefined unless zero is set.
+        Grid& acquire(const bool zero = true);
+
+        /// Return a grid to the pool.
+        void release(Grid& grid);
+
+        size_t allocations() const { return m_all.size(); }
+        size_t reuses() const { return m_reuses; }
+        size_t gridBytes() const { return m_nPixels * sizeof(std::complex<float>); }
+        size_t bytesInUse() const { return m_inUse * gridBytes(); }
+        size_t peakBytesInUse() const { return m_peakInUse * gridBytes(); }
+
+    private:
+        // Not copyable
+        GridPool(const GridPool&);
+        GridPool& operator=(const GridPool&);
+
+        size_t m_nPixels;
+        std::vector<Grid*> m_all;
+        std::vector<Grid*> m_free;
+        size_t m_reuses;
+        size_t m_inUse;
+        size_t m_peakInUse;
+};
+
+#endif
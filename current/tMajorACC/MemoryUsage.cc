@@ -0,0 +1,235 @@
+/// @copyright (c) 2017 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+
+// Include own header file first
+#include "MemoryUsage.h"
+
+// System includes
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <iomanip>
+#include <atomic>
+#include <new>
+
+namespace {
+
+// Read a "Key:   1234 kB" line from /proc/self/status
+size_t readStatus(const char* key)
+{
+    FILE* fp = fopen("/proc/self/status", "r");
+    if (fp == NULL) {
+        return 0;
+    }
+    const size_t keylen = strlen(key);
+    char line[256];
+    size_t kB = 0;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (strncmp(line, key, keylen) == 0 && line[keylen] == ':') {
+            sscanf(line + keylen + 1, "%zu", &kB);
+            break;
+        }
+    }
+    fclose(fp);
+    return kB * 1024;
+}
+
+// Each block carries its size in a header. The header is as large as the
+// alignment malloc guarantees, so the returned pointer keeps it.
+const size_t kHeader = 16;
+
+std::atomic<size_t> s_heapBytes(0);
+std::atomic<size_t> s_peakHeapBytes(0);
+std::atomic<size_t> s_heapAllocations(0);
+
+void* countedAlloc(const size_t size)
+{
+    void* block = malloc(size + kHeader);
+    if (block == NULL) {
+        return NULL;
+    }
+    *static_cast<size_t*>(block) = size;
+
+    const size_t inUse = s_heapBytes.fetch_add(size) + size;
+    size_t peak = s_peakHeapBytes.load();
+    while (inUse > peak && !s_peakHeapBytes.compare_exchange_weak(peak, inUse)) {
+    }
+    s_heapAllocations++;
+
+    return static_cast<char*>(block) + kHeader;
+}
+
+void countedFree(void* ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    void* block = static_cast<char*>(ptr) - kHeader;
+    s_heapBytes.fetch_sub(*static_cast<size_t*>(block));
+    free(block);
+}
+
+void* countedNew(const size_t size)
+{
+    void* ptr = countedAlloc(size);
+    if (ptr == NULL) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+const double MB = 1024.0 * 1024.0;
+
+}
+
+// Counting replacements for the global allocation functions
+void* operator new(size_t size) { return countedNew(size); }
+void* operator new[](size_t size) { return countedNew(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void operator delete(void* ptr) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { countedFree(ptr); }
+
+MemoryUsage::MemoryUsage() : m_resetWorks(true)
+{
+}
+
+size_t MemoryUsage::currentRSS()
+{
+    return readStatus("VmRSS");
+}
+
+size_t MemoryUsage::peakRSS()
+{
+    return readStatus("VmHWM");
+}
+
+bool MemoryUsage::resetPeakRSS()
+{
+    FILE* fp = fopen("/proc/self/clear_refs", "w");
+    if (fp == NULL) {
+        return false;
+    }
+    const bool ok = (fputs("5", fp) >= 0);
+    return (fclose(fp) == 0) && ok;
+}
+
+size_t MemoryUsage::heapBytes()
+{
+    return s_heapBytes.load();
+}
+
+size_t MemoryUsage::peakHeapBytes()
+{
+    return s_peakHeapBytes.load();
+}
+
+size_t MemoryUsage::heapAllocations()
+{
+    return s_heapAllocations.load();
+}
+
+void MemoryUsage::resetHeapCounters()
+{
+    s_peakHeapBytes.store(s_heapBytes.load());
+    s_heapAllocations.store(0);
+}
+
+void MemoryUsage::beginStage()
+{
+    if (m_resetWorks) {
+        m_resetWorks = resetPeakRSS();
+    }
+}
+
+void MemoryUsage::endStage(const std::string& name)
+{
+    const size_t peak = peakRSS();
+    std::vector<std::string>::iterator it = std::find(m_names.begin(), m_names.end(), name);
+    if (it == m_names.end()) {
+        m_names.push_back(name);
+        m_peaks.push_back(peak);
+    } else {
+        size_t& stagePeak = m_peaks[it - m_names.begin()];
+        stagePeak = std::max(stagePeak, peak);
+    }
+}
+
+void MemoryUsage::addStructure(const std::string& name, const size_t bytes)
+{
+    std::vector<std::string>::iterator it = std::find(m_structNames.begin(), m_structNames.end(), name);
+    if (it == m_structNames.end()) {
+        m_structNames.push_back(name);
+        m_structBytes.push_back(bytes);
+    } else {
+        m_structBytes[it - m_structNames.begin()] += bytes;
+    }
+}
+
+void MemoryUsage::summary(std::vector<std::string>& labels, std::vector<double>& bytes) const
+{
+    labels.clear();
+    bytes.clear();
+
+    // Resetting the high water mark hides earlier peaks from VmHWM
+    size_t peak = peakRSS();
+    for (size_t i = 0; i < m_peaks.size(); ++i) {
+        peak = std::max(peak, m_peaks[i]);
+    }
+    labels.push_back("Peak RSS");
+    bytes.push_back(peak);
+    labels.push_back("Peak heap");
+    bytes.push_back(peakHeapBytes());
+
+    for (size_t i = 0; i < m_structNames.size(); ++i) {
+        labels.push_back("Structure " + m_structNames[i]);
+        bytes.push_back(m_structBytes[i]);
+    }
+    for (size_t i = 0; i < m_names.size(); ++i) {
+        labels.push_back("Stage " + m_names[i]);
+        bytes.push_back(m_peaks[i]);
+    }
+}
+
+void MemoryUsage::report(std::ostream& os) const
+{
+    std::vector<std::string> labels;
+    std::vector<double> bytes;
+    summary(labels, bytes);
+
+    os << "Memory";
+    if (!m_resetWorks) {
+        os << " (stage peaks are cumulative, could not reset the high water mark)";
+    }
+    os << std::endl;
+    for (size_t i = 0; i < labels.size(); ++i) {
+        os << "    " << std::left << std::setw(32) << labels[i] << std::right
+           << bytes[i] / MB << " (MB)" << std::endl;
+    }
+    os << "    " << std::left << std::setw(32) << "Heap allocations" << std::right
+       << heapAllocations() << std::endl;
+}
@@ -44,10 +44,15 @@
 // CUDA includes
 #ifdef GPU
 #include <cufft.h>
+#include <cuda_runtime_api.h>
 #endif
 
 // Local includes
 #include "Stopwatch.h"
+#include "Trace.h"
+#include "GridPool.h"
+#include "MemoryUsage.h"
+#include "ASKAPLayout.h"
 
 #if defined(VERIFY)
 	#define RUN_CPU 1
@@ -504,9 +509,13 @@ int fftExec(std::vector<std::complex<float> >& grid, const int gSize, const bool
     std::complex<float> *buffer = rotgrid.data();
 
     fftwf_plan plan;
-    plan = fftwf_plan_dft_2d( gSize, gSize, (fftwf_complex*)buffer, (fftwf_complex*)buffer,
-                              (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE );
+    {
+        TraceScope ts("fftw plan", "fft");
+        plan = fftwf_plan_dft_2d( gSize, gSize, (fftwf_complex*)buffer, (fftwf_complex*)buffer,
+                                  (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE );
+    }
 
+    uint64_t traceStart = Trace::now();
     for (int col = 0; col < gSize; col++) {
         const int colin = col * gSize;
         const int colout = ( ( col + gSize/2 ) % gSize ) * gSize;
@@ -520,9 +529,15 @@ int fftExec(std::vector<std::complex<float> >& grid, const int gSize, const bool
         }
     }
 
-    fftwf_execute(plan);
+    Trace::complete("fftshift", "fft", traceStart);
+
+    {
+        TraceScope ts("fftw execute", "fft");
+        fftwf_execute(plan);
+    }
 
     // rotate back
+    traceStart = Trace::now();
     for (int col = 0; col < gSize; col++) {
         const int colin = col * gSize;
         const int colout = ( ( col + gSize/2 ) % gSize ) * gSize;
@@ -536,6 +551,8 @@ int fftExec(std::vector<std::complex<float> >& grid, const int gSize, const bool
         }
     }
 
+    Trace::complete("fftshift", "fft", traceStart);
+
     // Delete the plan and temporary buffer
     fftwf_destroy_plan(plan);
     //fftwf_free(buffer);
@@ -560,10 +577,12 @@ int fftExecGPU(std::vector<std::complex<float> >& grid, const int gSize, const b
 
     cufftHandle plan;
 
+    uint64_t traceStart = Trace::now();
     if ( cufftPlan2d( &plan, gSize, gSize, CUFFT_C2C ) != CUFFT_SUCCESS ) {
         cout << "CUFFT error: Plan creation failed" << endl;
         return 1;
     }
+    Trace::complete("cufft plan", "fft", traceStart);
 
     std::complex<float> *dataPtr = grid.data();
 
@@ -575,6 +594,7 @@ int fftExecGPU(std::vector<std::complex<float> >& grid, const int gSize, const b
     #pragma acc enter data create(buffer[0:gSize*gSize])
 
     // rotate input because the origin for CUFFT is at 0, not n/2 (i.e. fftshfit)
+    traceStart = Trace::now();
     #pragma acc parallel loop collapse(2) present(dataPtr[0:gSize*gSize],buffer[0:gSize*gSize])
     for (int col = 0; col < gSize; col++) {
         for (int row = 0; row < gSize/2; row++) {
@@ -585,17 +605,24 @@ int fftExecGPU(std::vector<std::complex<float> >& grid, const int gSize, const b
         }
     }
 
+    Trace::complete("fftshift", "fft", traceStart);
+
     cufftResult fftErr;
+    traceStart = Trace::now();
     #pragma acc host_data use_device(buffer)
     {
         fftErr = cufftExecC2C(plan, (cufftComplex*)buffer, (cufftComplex*)buffer, (forward) ? CUFFT_FORWARD : CUFFT_INVERSE);
     }
+    // cufftExecC2C is asynchronous, so wait for it to finish before closing the event
+    if (Trace::enabled()) cudaDeviceSynchronize();
+    Trace::complete("cufft execute", "fft", traceStart);
     if ( fftErr != CUFFT_SUCCESS ) {
         cout << "CUFFT error: Forward FFT failed" << endl;
         return 1;
     }
  
     // rotate back
+    traceStart = Trace::now();
     #pragma acc parallel loop collapse(2) present(dataPtr[0:gSize*gSize],buffer[0:gSize*gSize])
     for (int col = 0; col < gSize; col++) {
         for (int row = 0; row < gSize/2; row++) {
@@ -606,6 +633,8 @@ int fftExecGPU(std::vector<std::complex<float> >& grid, const int gSize, const b
         }
     }
 
+    Trace::complete("fftshift", "fft", traceStart);
+
     #pragma acc exit data delete(buffer[0:gSize*gSize])
 
     // Delete the plan
@@ -659,6 +688,17 @@ int randomInt()
 // ------------------------------------------------------------------------- //
 // Hogbom stuff
 
+// Number of minor cycle iterations per trace event
+static const unsigned int traceBatch = 10;
+
+// A clean component. The model image is never more than a list of these,
+// so it is kept in this form and only expanded onto a grid when needed.
+struct Component {
+    Component(size_t _pos, float _val) : pos(_pos), val(_val) { };
+    size_t pos;
+    float val;
+};
+
 void writeImage(const std::string& filename, std::vector<std::complex<float> >& image)
 {
     std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
@@ -783,17 +823,20 @@ void subtractPsfACC(const std::complex<float> *psfdata,
     }
 }
 
-void deconvolve(std::vector<std::complex<float> >& residual,
+// Hogbom clean of at most g_niters iterations. The minor cycle stops early
+// once the peak residual falls below the larger of g_threshold and
+// cycleFraction times the initial peak. Returns the number of iterations
+// run; peakVal is the last peak residual found.
+int deconvolve(std::vector<std::complex<float> >& residual,
                 const size_t dirtyWidth,
                 const std::vector<std::complex<float> >& psf,
                 const size_t psfWidth,
-                std::vector<std::complex<float> >& model,
-                const int g_niters)
+                std::vector<Component>& model,
+                const int g_niters, const float g_threshold,
+                const float cycleFraction, float& peakVal)
 {
 
     const float g_gain = 0.1;
-    // disable this to keep things more readily comparable
-    //float g_threshold;
 
     // Find the peak of the PSF
     float psfPeakVal = 0.0;
@@ -802,7 +845,14 @@ void deconvolve(std::vector<std::complex<float> >& residual,
     cout << "    PSF peak (cpu): " << "Maximum = " << psfPeakVal << " at location "
          << idxToPos(psfPeakPos, psfWidth).x << "," << idxToPos(psfPeakPos, psfWidth).y << endl;
 
-    for (unsigned int i = 0; i < g_niters; ++i) {
+    float cycleThreshold = g_threshold;
+    peakVal = 0.0;
+
+    uint64_t traceStart = 0;
+    int i;
+    for (i = 0; i < g_niters; ++i) {
+        if (i % traceBatch == 0) traceStart = Trace::now();
+
         // Find the peak in the residual image
         float absPeakVal = 0.0;
         size_t absPeakPos = 0;
@@ -810,33 +860,37 @@ void deconvolve(std::vector<std::complex<float> >& residual,
         if (i==0) {
             cout << "    dirty peak (cpu): " << "Maximum = " << absPeakVal << " at location "
                  << idxToPos(absPeakPos, dirtyWidth).x << "," << idxToPos(absPeakPos, dirtyWidth).y << endl;
+            cycleThreshold = std::max(g_threshold, cycleFraction * abs(absPeakVal));
         }
+        peakVal = absPeakVal;
         // Check if threshold has been reached
-        //if (i==0) g_threshold = 1e-3 * abs(absPeakVal);
-        //if (abs(absPeakVal) < g_threshold) {
-        //    cout << "Reached stopping threshold" << endl;
-        //    break;
-        //}
+        if (abs(absPeakVal) < cycleThreshold) {
+            Trace::complete("minor cycle batch", "cpu", traceStart);
+            break;
+        }
 
         // Add to model
-        model[absPeakPos] += absPeakVal * g_gain;
+        model.push_back(Component(absPeakPos, absPeakVal * g_gain));
 
         // Subtract the PSF from the residual image
         subtractPsf(psf, psfWidth, residual, dirtyWidth, absPeakPos, psfPeakPos, absPeakVal, g_gain);
+
+        if ((i+1) % traceBatch == 0 || i+1 == g_niters) Trace::complete("minor cycle batch", "cpu", traceStart);
     }
+
+    return i;
 }
 
-void deconvolveACC(std::vector<std::complex<float> >& residual,
+int deconvolveACC(std::vector<std::complex<float> >& residual,
                 const size_t dirtyWidth,
                 const std::vector<std::complex<float> >& psf,
                 const size_t psfWidth,
-                std::vector<std::complex<float> >& model,
-                const int g_niters)
+                std::vector<Component>& model,
+                const int g_niters, const float g_threshold,
+                const float cycleFraction, float& peakVal)
 {
 
     const float g_gain = 0.1;
-    // disable this to keep things more readily comparable
-    //float g_threshold;
 
     // referece the basic data arrays for use in the parallel loop
     const std::complex<float> *psfdata = psf.data();
@@ -851,7 +905,14 @@ void deconvolveACC(std::vector<std::complex<float> >& residual,
     cout << "    PSF peak (acc): " << "Maximum = " << psfPeakVal << " at location "
          << idxToPos(psfPeakPos, psfWidth).x << "," << idxToPos(psfPeakPos, psfWidth).y << endl;
 
-    for (unsigned int i = 0; i < g_niters; ++i) {
+    float cycleThreshold = g_threshold;
+    peakVal = 0.0;
+
+    uint64_t traceStart = 0;
+    int i;
+    for (i = 0; i < g_niters; ++i) {
+        if (i % traceBatch == 0) traceStart = Trace::now();
+
         // Find the peak in the residual image
         float absPeakVal = 0.0;
         size_t absPeakPos = 0;
@@ -859,21 +920,133 @@ void deconvolveACC(std::vector<std::complex<float> >& residual,
         if (i==0) {
             cout << "    dirty peak (acc): " << "Maximum = " << absPeakVal << " at location "
                  << idxToPos(absPeakPos, dirtyWidth).x << "," << idxToPos(absPeakPos, dirtyWidth).y << endl;
+            cycleThreshold = std::max(g_threshold, cycleFraction * abs(absPeakVal));
         }
+        peakVal = absPeakVal;
 
         // Check if threshold has been reached
-        //if (i==0) g_threshold = 1e-3 * abs(absPeakVal);
-        //if (abs(absPeakVal) < g_threshold) {
-        //    cout << "Reached stopping threshold" << endl;
-        //    break;
-        //}
+        if (abs(absPeakVal) < cycleThreshold) {
+            Trace::complete("minor cycle batch", "acc", traceStart);
+            break;
+        }
 
         // Add to model
-        model[absPeakPos] += absPeakVal * g_gain;
+        model.push_back(Component(absPeakPos, absPeakVal * g_gain));
 
         // Subtract the PSF from the residual image
         subtractPsfACC(psfdata, psfWidth, resdata, dirtyWidth, absPeakPos, psfPeakPos, absPeakVal, g_gain);
+
+        if ((i+1) % traceBatch == 0 || i+1 == g_niters) Trace::complete("minor cycle batch", "acc", traceStart);
+    }
+
+    return i;
+}
+
+// Largest PSF sidelobe relative to the peak. The main lobe is taken to end
+// at the first minimum along the row through the peak.
+float psfSidelobe(const std::vector<std::complex<float> >& psf, const size_t psfWidth)
+{
+    float peakVal = 0.0;
+    size_t peakPos = 0;
+    findPeak(psf, peakVal, peakPos);
+    const int px = idxToPos(peakPos, psfWidth).x;
+    const int py = idxToPos(peakPos, psfWidth).y;
+
+    int radius = 1;
+    while ((px + radius + 1 < int(psfWidth)) &&
+           (abs(psf[peakPos + radius + 1].real()) < abs(psf[peakPos + radius].real()))) {
+        radius++;
+    }
+
+    float sidelobe = 0.0;
+    for (int y = 0; y < int(psfWidth); ++y) {
+        for (int x = 0; x < int(psfWidth); ++x) {
+            const int dx = x - px;
+            const int dy = y - py;
+            if (dx*dx + dy*dy <= radius*radius) continue;
+            sidelobe = std::max(sidelobe, abs(psf[posToIdx(psfWidth, Position(x, y))].real()));
+        }
+    }
+
+    return sidelobe / abs(peakVal);
+}
+
+// Expand clean components onto a grid, overwriting its contents
+void modelImage(const std::vector<Component>& model, std::vector<std::complex<float> >& grid)
+{
+    grid.assign(grid.size(), std::complex<float>(0.0));
+    for (size_t i = 0; i < model.size(); ++i) {
+        grid[model[i].pos] += model[i].val;
+    }
+}
+
+// Expand clean components onto a device grid. Only the component list is
+// sent to the device, rather than a full model grid.
+void modelImageACC(const std::vector<Component>& model, std::vector<std::complex<float> >& grid)
+{
+    std::complex<float> *dataPtr = grid.data();
+    const size_t nPixels = grid.size();
+    const Component *comp = model.data();
+    const int nComp = model.size();
+
+    #pragma acc parallel loop present(dataPtr[0:nPixels])
+    for (size_t i = 0; i < nPixels; i++) {
+        dataPtr[i] = 0.0;
+    }
+    // the same pixel can be selected more than once
+    #pragma acc parallel loop present(dataPtr[0:nPixels]) copyin(comp[0:nComp])
+    for (int i = 0; i < nComp; i++) {
+        float *dref = (float *)&dataPtr[comp[i].pos];
+        #pragma acc atomic update
+        dref[0] = dref[0] + comp[i].val;
+    }
+}
+
+#ifdef RUN_VERIFY
+// Keep every stride'th pixel of a grid for verification. The copy is only
+// allocated when first needed.
+void saveSample(const std::vector<std::complex<float> >& grid,
+                std::vector<std::complex<float> >& sample, const int stride)
+{
+    sample.resize((grid.size() + stride - 1) / stride);
+    for (size_t i = 0, j = 0; i < grid.size(); i += stride, ++j) {
+        sample[j] = grid[i];
+    }
+}
+
+// Free a verification copy
+void freeSample(std::vector<std::complex<float> >& sample)
+{
+    std::vector<std::complex<float> >().swap(sample);
+}
+#endif
+
+// Smallest even size no less than n with no prime factors above 7, which
+// FFTW and cuFFT handle efficiently
+int goodFFTSize(const int n)
+{
+    for (int size = std::max(2, n + n%2); ; size += 2) {
+        int r = size;
+        const int factors[] = {2, 3, 5, 7};
+        for (int f = 0; f < 4; ++f) {
+            while (r % factors[f] == 0) r /= factors[f];
+        }
+        if (r == 1) return size;
+    }
+}
+
+// Count the samples whose convolution footprint falls off the grid
+int checkGridBounds(const std::vector<int>& iu, const std::vector<int>& iv,
+                    const int support, const int gSize)
+{
+    int nBad = 0;
+    for (size_t i = 0; i < iu.size(); ++i) {
+        if ((iu[i] - support < 0) || (iu[i] + support >= gSize) ||
+            (iv[i] < 0) || (iv[i] + 2*support >= gSize)) {
+            nBad++;
+        }
     }
+    return nBad;
 }
 
 void usage() {
@@ -882,6 +1055,15 @@ void usage() {
     cout << "-w num\t change the number of lookup planes in w projection to num." << endl;
     cout << "-c num\t change the number of spectral channels to num." << endl;
     cout << "-f val\t reduce the field of view by a factor of val (=> reduce the kernel size)." << endl;
+    cout << "-v num\t verify every num'th pixel of each grid (default 1, only with -DVERIFY)." << endl;
+    cout << "-g num\t grid size in pixels, rounded up to an FFT-friendly size (default 4096, 0 for the smallest that fits)." << endl;
+    cout << "-M num\t change the number of major cycles to num (default 5)." << endl;
+    cout << "-m num\t change the number of minor cycle iterations to num (default 100)." << endl;
+    cout << "-s num\t change the number of simulated point sources to num (default 100)." << endl;
+    cout << "-u type\t uvw sampling: askap (ASKAP antenna layout, default) or random." << endl;
+    cout << "-T val\t stop once the peak residual is below val (default 0, run all major cycles)." << endl;
+    cout << "-F val\t end each minor cycle at val * PSF sidelobe * peak residual (default 0, run all iterations)." << endl;
+    cout << "-I num\t limit the minor cycle iterations summed over all major cycles to num (default 0, no limit)." << endl;
 }
 
 // ------------------------------------------------------------------------- //
@@ -893,6 +1075,17 @@ int main(int argc, char* argv[])
     int wSize = 33; // Number of lookup planes in w projection
     int nChan = 1; // Number of spectral channels
     Coord cellSize = 5.0; // Cellsize of output grid in wavelengths
+#ifdef RUN_VERIFY
+    int verifyStride = 1; // Sampling of grid pixels during verification
+#endif
+    int gSize = 4096; // Size of output grid in pixels
+    int nMajor = 5; // Number of major cycle iterations
+    int nMinor = 100; // Number of minor cycle iterations
+    int nSources = 100; // Number of point sources in the true sky
+    std::string uvwType = "askap"; // How uvw samples are generated
+    float threshold = 0.0; // Stop cleaning once the peak residual is below this
+    float cycleFactor = 0.0; // Minor cycle threshold relative to peak residual and PSF sidelobe
+    int maxIter = 0; // Limit on minor cycle iterations over all major cycles (0 for none)
 
     if (argc > 1){
         for (int i=0; i < argc; i++){
@@ -910,6 +1103,44 @@ int main(int argc, char* argv[])
                     cellSize *= atof(argv[i+1]);
                     i++;
                 }
+#ifdef RUN_VERIFY
+                else if (argv[i][1] == 'v') {
+                    verifyStride = std::max(1, atoi(argv[i+1]));
+                    i++;
+                }
+#endif
+                else if (argv[i][1] == 'g') {
+                    gSize = atoi(argv[i+1]);
+                    i++;
+                }
+                else if (argv[i][1] == 'M') {
+                    nMajor = atoi(argv[i+1]);
+                    i++;
+                }
+                else if (argv[i][1] == 'm') {
+                    nMinor = atoi(argv[i+1]);
+                    i++;
+                }
+                else if (argv[i][1] == 's') {
+                    nSources = atoi(argv[i+1]);
+                    i++;
+                }
+                else if (argv[i][1] == 'u') {
+                    uvwType = argv[i+1];
+                    i++;
+                }
+                else if (argv[i][1] == 'T') {
+                    threshold = atof(argv[i+1]);
+                    i++;
+                }
+                else if (argv[i][1] == 'F') {
+                    cycleFactor = atof(argv[i+1]);
+                    i++;
+                }
+                else if (argv[i][1] == 'I') {
+                    maxIter = atoi(argv[i+1]);
+                    i++;
+                }
                 else {
                     usage();
                     return 1;
@@ -921,29 +1152,57 @@ int main(int argc, char* argv[])
     cout << "nChan = " << nChan <<endl;
     cout << "wSize = " << wSize <<endl;
     cout << "cellSize = " << cellSize <<endl;
+    cout << "nMajor = " << nMajor <<endl;
+    cout << "nMinor = " << nMinor <<endl;
+    cout << "nSources = " << nSources <<endl;
+    cout << "uvw = " << uvwType <<endl;
+    cout << "threshold = " << threshold <<endl;
+    cout << "cycleFactor = " << cycleFactor <<endl;
+    cout << "maxIter = " << maxIter <<endl;
+
+    if ((uvwType != "askap") && (uvwType != "random")) {
+        usage();
+        return 1;
+    }
+    if ((nMajor < 1) || (nMinor < 1) || (nSources < 0) || (gSize < 0) ||
+        (threshold < 0.0) || (cycleFactor < 0.0) || (maxIter < 0)) {
+        usage();
+        return 1;
+    }
+
+    // Timeline tracing is enabled by setting ASKAP_TRACE to an output file name
+    Trace::init();
 
     // Don't change any of these numbers unless you know what you are doing!
-    const int gSize = 4096; // Size of output grid in pixels
     const int baseline = 2000; // Maximum baseline in meters
 
-    const int nMajor = 5; // Number of major cycle iterations
-    const int nMinor = 100; // Number of minor cycle iterations
-
     const unsigned int maxint = std::numeric_limits<int>::max();
 
     // Initialize the uvw data 
     std::vector<Coord> u(nSamples);
     std::vector<Coord> v(nSamples);
     std::vector<Coord> w(nSamples);
-    for (int i = 0; i < nSamples; i++) {
-        u[i] = baseline * Coord(randomInt()) / Coord(maxint) - baseline / 2;
-        v[i] = baseline * Coord(randomInt()) / Coord(maxint) - baseline / 2;
-        w[i] = baseline * Coord(randomInt()) / Coord(maxint) - baseline / 2;
+    if (uvwType == "askap") {
+        // 12 hour track of the ASKAP baselines no longer than baseline,
+        // pointed at the zenith at transit
+        const Coord obslen = 12.;
+        const Coord dec = ASKAPLayout::latitude();
+        const ASKAPLayout layout(baseline);
+        const int nBaselines = layout.nBaselines();
+        cout << "nBaselines = " << nBaselines << endl;
+        for (int i = 0; i < nSamples; i++) {
+            const int bl = nBaselines * (Coord(randomInt()) / Coord(maxint));
+            const Coord ha = obslen * 3.141593/12.0 * ((Coord(randomInt()) / Coord(maxint)) - 0.5);
+            layout.uvw(bl, ha, dec, u[i], v[i], w[i]);
+        }
+    } else {
+        for (int i = 0; i < nSamples; i++) {
+            u[i] = baseline * Coord(randomInt()) / Coord(maxint) - baseline / 2;
+            v[i] = baseline * Coord(randomInt()) / Coord(maxint) - baseline / 2;
+            w[i] = baseline * Coord(randomInt()) / Coord(maxint) - baseline / 2;
+        }
     }
 
-    std::vector<std::complex<float> > grid(gSize*gSize);
-    grid.assign(grid.size(), std::complex<float>(0.0));
-
     // Measure frequency in inverse wavelengths
     std::vector<Coord> freq(nChan);
 
@@ -963,9 +1222,54 @@ int main(int argc, char* argv[])
     std::vector<int> iv;
     Coord wCellSize;
 
-    initC(freq, cellSize, baseline, wSize, support, overSample, wCellSize, C);
-    initCOffset(u, v, w, freq, cellSize, wCellSize, wSize, gSize, support,
-                overSample, cOffset, iu, iv);
+    {
+        TraceScope ts("initC", "init");
+        initC(freq, cellSize, baseline, wSize, support, overSample, wCellSize, C);
+    }
+    // Size the grid to hold the convolution footprint of every sample
+    {
+        Coord uvMax = 0.0;
+        for (int i = 0; i < nSamples; i++) {
+            uvMax = std::max(uvMax, std::max(std::abs(u[i]), std::abs(v[i])));
+        }
+        // freq[0] is the highest frequency
+        uvMax *= freq[0] / cellSize;
+        const int minSize = 2 * (int(ceil(uvMax)) + 2*support + 1);
+        const int requested = gSize;
+        gSize = goodFFTSize(gSize == 0 ? minSize : gSize);
+        cout << "gSize = " << gSize;
+        if (requested == 0) {
+            cout << " (smallest that fits)";
+        } else if (gSize != requested) {
+            cout << " (padded from " << requested << ")";
+        }
+        cout << ", uv coverage needs " << minSize << endl;
+        if (gSize < minSize) {
+            cout << "Grid too small for the uv coverage: use -g " << goodFFTSize(minSize)
+                 << " or more, or reduce the field of view with -f" << endl;
+            return 1;
+        }
+    }
+
+    // All full-size grids come from the pool, so the number allocated is
+    // the number needed at the busiest point of the cycle
+    GridPool pool(gSize*gSize);
+    MemoryUsage mem;
+
+    {
+        TraceScope ts("initCOffset", "init");
+        initCOffset(u, v, w, freq, cellSize, wCellSize, wSize, gSize, support,
+                    overSample, cOffset, iu, iv);
+    }
+
+    // Out of range samples would silently corrupt memory, so check before gridding
+    {
+        const int nBad = checkGridBounds(iu, iv, support, gSize);
+        if (nBad > 0) {
+            cout << nBad << " samples fall off the edge of the grid" << endl;
+            return 1;
+        }
+    }
 
     const int sSize = 2 * support + 1;
 
@@ -984,9 +1288,7 @@ int main(int argc, char* argv[])
     ///////////////////////////////////////////////////////////////////////////
 
     // make an image of point sources (the true sky)
-    const int nSources = 100;
-    std::vector<std::complex<float> > trueGrid(gSize*gSize);
-    trueGrid.assign(trueGrid.size(), std::complex<float>(0.0));
+    GridPool::Grid& trueGrid = pool.acquire();
     // record a few test positions for later
     for (int i = 0; i < nSources; i++) {
         int l = gSize * Coord(randomInt()) / Coord(maxint);
@@ -1006,11 +1308,17 @@ int main(int argc, char* argv[])
     std::vector<std::complex<float> > visData(nSamples*nChan);
     std::complex<float> *visData_d = visData.data();
     std::complex<float> *trueGrid_d = trueGrid.data();
-    #pragma acc enter data create(visData_d[0:nSamples*nChan]) copyin(trueGrid_d[0:gSize*gSize])
-    degridKernelACC(trueGrid, gSize, support, C, cOffset, iu, iv, visData);
-    #pragma acc exit data delete(trueGrid_d[0:gSize*gSize]) async(2)
-    // pull the data back to the CPU and delete/deallocate the GPU copy
-    #pragma acc exit data copyout(visData_d[0:nSamples*nChan])
+    {
+        TraceScope ts("simulate visibilities", "init");
+        #pragma acc enter data create(visData_d[0:nSamples*nChan]) copyin(trueGrid_d[0:gSize*gSize])
+        degridKernelACC(trueGrid, gSize, support, C, cOffset, iu, iv, visData);
+        #pragma acc exit data delete(trueGrid_d[0:gSize*gSize]) async(2)
+        // pull the data back to the CPU and delete/deallocate the GPU copy
+        #pragma acc exit data copyout(visData_d[0:nSamples*nChan])
+        #pragma acc wait(2)
+    }
+    // the true sky is no longer needed, so its memory can be reused
+    pool.release(trueGrid);
 
 #ifdef RUN_CPU
     // make a single-core cpu copy
@@ -1020,8 +1328,9 @@ int main(int argc, char* argv[])
         cpuModel[i] = 0.0;
     }
     // set main single-core cpu scratch arrays
-    std::vector<std::complex<float> > cpuPsfGrid(gSize*gSize);
-    std::vector<std::complex<float> > cpuImgGrid(gSize*gSize);
+    GridPool::Grid& cpuPsfGrid = pool.acquire(false);
+    GridPool::Grid& cpuImgGrid = pool.acquire(false);
+    std::vector<Component> cpuModelComps;
 #endif
 
     // make an acc copy and send initial visibility data to the device
@@ -1036,8 +1345,9 @@ int main(int argc, char* argv[])
         accModel_d[i] = 0.0;
     }
     // set main acc scratch arrays
-    std::vector<std::complex<float> > accPsfGrid(gSize*gSize);
-    std::vector<std::complex<float> > accImgGrid(gSize*gSize);
+    GridPool::Grid& accPsfGrid = pool.acquire(false);
+    GridPool::Grid& accImgGrid = pool.acquire(false);
+    std::vector<Component> accModelComps;
     std::complex<float> *accPsfGrid_d = accPsfGrid.data();
     std::complex<float> *accImgGrid_d = accImgGrid.data();
     #pragma acc enter data create(accPsfGrid_d[0:gSize*gSize], accImgGrid_d[0:gSize*gSize])
@@ -1057,17 +1367,35 @@ int main(int argc, char* argv[])
     double HogbomAccTimer = 0.0;
     double fftAccTimer = 0.0;
     double degridAccTimer = 0.0;
+
+    // stopping criteria, tracked separately for each version
+#ifdef RUN_CPU
+    float cpuSidelobe = 0.0;
+    float cpuPeak = 0.0;
+    int cpuIters = 0;
+    double cpuConvergeTime = 0.0;
+#endif
+    float accSidelobe = 0.0;
+    float accPeak = 0.0;
+    int accIters = 0;
+    double accConvergeTime = 0.0;
+    bool converged = false;
+    int nCycles = 0;
+
 #ifdef RUN_VERIFY
-    std::vector<std::complex<float> > cpuuvPsf(gSize*gSize);
-    std::vector<std::complex<float> > cpuuvGrid(gSize*gSize);
-    std::vector<std::complex<float> > cpulmPsf(gSize*gSize);
-    std::vector<std::complex<float> > cpulmGrid(gSize*gSize);
-    std::vector<std::complex<float> > cpulmRes(gSize*gSize);
-    std::vector<std::complex<float> > accuvPsf(gSize*gSize);
-    std::vector<std::complex<float> > accuvGrid(gSize*gSize);
-    std::vector<std::complex<float> > acclmPsf(gSize*gSize);
-    std::vector<std::complex<float> > acclmGrid(gSize*gSize);
-    std::vector<std::complex<float> > acclmRes(gSize*gSize);
+    // verification copies, sampled every verifyStride pixels and allocated on first use
+    std::vector<std::complex<float> > cpuuvPsf;
+    std::vector<std::complex<float> > cpuuvGrid;
+    std::vector<std::complex<float> > cpulmPsf;
+    std::vector<std::complex<float> > cpulmGrid;
+    std::vector<std::complex<float> > cpulmRes;
+    std::vector<std::complex<float> > cpulmModel;
+    std::vector<std::complex<float> > accuvPsf;
+    std::vector<std::complex<float> > accuvGrid;
+    std::vector<std::complex<float> > acclmPsf;
+    std::vector<std::complex<float> > acclmGrid;
+    std::vector<std::complex<float> > acclmRes;
+    std::vector<std::complex<float> > acclmModel;
     float psfScale = 1.0;
 #endif
 
@@ -1085,30 +1413,39 @@ int main(int argc, char* argv[])
 
         Stopwatch sw_cpu;
         sw_cpu.start();
+        const uint64_t cpuTraceStart = Trace::now();
 
         //-----------------------------------------------------------------------//
         // DO GRIDDING
         if (it_major == 0)
         {
+            mem.beginStage();
             Stopwatch sw;
             sw.start();
+            const uint64_t traceStart = Trace::now();
             cpuPsfGrid.assign(cpuPsfGrid.size(), std::complex<float>(0.0));
             gridKernel(cpuData, support, C, cOffset, iu, iv, cpuPsfGrid, gSize, true);
             psfCpuTimer += sw.stop();
+            Trace::complete("grid psf", "cpu", traceStart);
+            mem.endStage("cpu grid psf");
 #ifdef RUN_VERIFY
             // Save copies for varification
-            cpuuvPsf = cpuPsfGrid;
+            saveSample(cpuPsfGrid, cpuuvPsf, verifyStride);
 #endif
         }
         {
+            mem.beginStage();
             Stopwatch sw;
             sw.start();
+            const uint64_t traceStart = Trace::now();
             cpuImgGrid.assign(cpuImgGrid.size(), std::complex<float>(0.0));
             gridKernel(cpuData, support, C, cOffset, iu, iv, cpuImgGrid, gSize, false);
             imgCpuTimer += sw.stop();
+            Trace::complete("grid", "cpu", traceStart);
+            mem.endStage("cpu grid");
 #ifdef RUN_VERIFY
             // Save copies for varification
-            cpuuvGrid = cpuImgGrid;
+            saveSample(cpuImgGrid, cpuuvGrid, verifyStride);
 #endif
         }
 
@@ -1125,68 +1462,96 @@ int main(int argc, char* argv[])
             fftFix(cpuPsfGrid, 1.0/float(cpuData.size()));
 #ifdef RUN_VERIFY
             // Save copies for varification
-            cpulmPsf = cpuPsfGrid;
+            saveSample(cpuPsfGrid, cpulmPsf, verifyStride);
 #endif
+            if (cycleFactor > 0.0) {
+                cpuSidelobe = psfSidelobe(cpuPsfGrid, gSize);
+                cout << "    PSF sidelobe (cpu): " << cpuSidelobe << endl;
+            }
         }
  
         // FFT gridded data to form dirty image
         {
+            mem.beginStage();
             Stopwatch sw;
             sw.start();
+            const uint64_t traceStart = Trace::now();
             if ( fftExec(cpuImgGrid, gSize, false) != 0 ) {
                 cout << "inverse fftExec error" << endl;
                 return -1;
             }
             fftFix(cpuImgGrid, 1.0/float(cpuData.size()));
             ifftCpuTimer += sw.stop();
+            Trace::complete("inverse fft", "cpu", traceStart);
+            mem.endStage("cpu inverse fft");
 #ifdef RUN_VERIFY
             // Save copies for varification
-            cpulmGrid = cpuImgGrid;
+            saveSample(cpuImgGrid, cpulmGrid, verifyStride);
 #endif
         }
 
         //-------------------------------------------------------------------//
         // Do Hogbom CLEAN
 
-        std::vector<std::complex<float> > cpuModelGrid(cpuImgGrid.size());
-        cpuModelGrid.assign(cpuModelGrid.size(), std::complex<float>(0.0));
+        cpuModelComps.clear();
         {
+            mem.beginStage();
             Stopwatch sw;
             sw.start();
-            deconvolve(cpuImgGrid, gSize, cpuPsfGrid, gSize, cpuModelGrid, nMinor);
+            const uint64_t traceStart = Trace::now();
+            const int nIter = (maxIter > 0) ? std::min(nMinor, maxIter - cpuIters) : nMinor;
+            const int nDone = deconvolve(cpuImgGrid, gSize, cpuPsfGrid, gSize, cpuModelComps,
+                                         nIter, threshold, cycleFactor * cpuSidelobe, cpuPeak);
+            cpuIters += nDone;
             HogbomCpuTimer += sw.stop();
+            Trace::complete("clean", "cpu", traceStart);
+            mem.endStage("cpu clean");
+            cout << "    minor cycles (cpu): " << nDone << ", peak residual " << cpuPeak << endl;
 #ifdef RUN_VERIFY
             // Save a copy for varification
-            cpulmRes = cpuImgGrid;
+            saveSample(cpuImgGrid, cpulmRes, verifyStride);
 #endif
         }
 
-        // Set the main scratch grid to the model (just use the model?)
-        cpuImgGrid = cpuModelGrid;
+        // The residual is no longer needed, so expand the clean components
+        // into the same grid rather than allocating a model grid
+        modelImage(cpuModelComps, cpuImgGrid);
+#ifdef RUN_VERIFY
+        saveSample(cpuImgGrid, cpulmModel, verifyStride);
+#endif
 
         //-------------------------------------------------------------------//
         // FFT deconvolved model image for degridding
         {
+            mem.beginStage();
             Stopwatch sw;
             sw.start();
-            // this should be the model, not cpuImgGrid
+            const uint64_t traceStart = Trace::now();
             if ( fftExec(cpuImgGrid, gSize, true) != 0 ) {
                 cout << "forward fftExec error" << endl;
                 return -1;
             }
             fftCpuTimer += sw.stop();
+            Trace::complete("forward fft", "cpu", traceStart);
+            mem.endStage("cpu forward fft");
         }
 
         //-----------------------------------------------------------------------//
         // DO DEGRIDDING
         {
+            mem.beginStage();
             Stopwatch sw;
             sw.start();
+            const uint64_t traceStart = Trace::now();
             degridKernel(cpuImgGrid, gSize, support, C, cOffset, iu, iv, cpuModel);
             degridCpuTimer += sw.stop();
+            Trace::complete("degrid", "cpu", traceStart);
+            mem.endStage("cpu degrid");
         }
 
         double cpu_time = sw_cpu.stop();
+        cpuConvergeTime += cpu_time;
+        Trace::complete("major cycle", "cpu", cpuTraceStart);
         cout << "    time " << cpu_time << " (s)" << endl;
 
 #endif
@@ -1197,40 +1562,55 @@ int main(int argc, char* argv[])
 
         Stopwatch sw_acc;
         sw_acc.start();
+        const uint64_t accTraceStart = Trace::now();
 
         //-----------------------------------------------------------------------//
         // DO GRIDDING
         if (it_major == 0)
         {
             // Time is measured inside this function call, unlike the CPU versions
+            mem.beginStage();
             Stopwatch sw;
             sw.start();
+            const uint64_t traceStart = Trace::now();
             #pragma acc parallel loop present(accPsfGrid_d[0:gSize*gSize])
             for (unsigned int i = 0; i < gSize*gSize; ++i) {
                 accPsfGrid_d[i] = 0.0;
             }
             gridKernelACC(accData, support, C, cOffset, iu, iv, accPsfGrid, gSize, true);
             psfAccTimer += sw.stop();
+            Trace::complete("grid psf", "acc", traceStart);
+            mem.endStage("acc grid psf");
 #ifdef RUN_VERIFY
             // Save copies for varification
-            #pragma acc update host(accPsfGrid_d[0:gSize*gSize])
-            accuvPsf = accPsfGrid;
+            {
+                TraceScope ts("verify copy", "transfer");
+                #pragma acc update host(accPsfGrid_d[0:gSize*gSize])
+                saveSample(accPsfGrid, accuvPsf, verifyStride);
+            }
 #endif
         }
         {
             // Time is measured inside this function call, unlike the CPU versions
+            mem.beginStage();
             Stopwatch sw;
             sw.start();
+            const uint64_t traceStart = Trace::now();
             #pragma acc parallel loop present(accImgGrid_d[0:gSize*gSize])
             for (unsigned int i = 0; i < gSize*gSize; ++i) {
                 accImgGrid_d[i] = 0.0;
             }
             gridKernelACC(accData, support, C, cOffset, iu, iv, accImgGrid, gSize, false);
             imgAccTimer += sw.stop();
+            Trace::complete("grid", "acc", traceStart);
+            mem.endStage("acc grid");
 #ifdef RUN_VERIFY
             // Save copies for varification
-            #pragma acc update host(accImgGrid_d[0:gSize*gSize])
-            accuvGrid = accImgGrid;
+            {
+                TraceScope ts("verify copy", "transfer");
+                #pragma acc update host(accImgGrid_d[0:gSize*gSize])
+                saveSample(accImgGrid, accuvGrid, verifyStride);
+            }
 #endif
         }
 
@@ -1258,15 +1638,27 @@ int main(int argc, char* argv[])
             #endif
 #ifdef RUN_VERIFY
             // Save copies for varification
-            #pragma acc update host(accPsfGrid_d[0:gSize*gSize])
-            acclmPsf = accPsfGrid;
+            {
+                TraceScope ts("verify copy", "transfer");
+                #pragma acc update host(accPsfGrid_d[0:gSize*gSize])
+                saveSample(accPsfGrid, acclmPsf, verifyStride);
+            }
 #endif
+            if (cycleFactor > 0.0) {
+                // the sidelobe level is found once, on the host
+                TraceScope ts("psf sidelobe", "acc");
+                #pragma acc update host(accPsfGrid_d[0:gSize*gSize])
+                accSidelobe = psfSidelobe(accPsfGrid, gSize);
+                cout << "    PSF sidelobe (acc): " << accSidelobe << endl;
+            }
         }
 
         // FFT gridded data to form dirty image
         {
+            mem.beginStage();
             Stopwatch sw;
             sw.start();
+            const uint64_t traceStart = Trace::now();
             #ifdef GPU
             // Use CUFFT
             if ( fftExecGPU(accImgGrid, gSize, false) != 0 ) {
@@ -1284,40 +1676,65 @@ int main(int argc, char* argv[])
             fftFix(accImgGrid, 1.0/float(accData.size()));
             #endif
             ifftAccTimer += sw.stop();
+            Trace::complete("inverse fft", "acc", traceStart);
+            mem.endStage("acc inverse fft");
 #ifdef RUN_VERIFY
             // Save copies for varification
-            #pragma acc update host(accImgGrid_d[0:gSize*gSize])
-            acclmGrid = accImgGrid;
+            {
+                TraceScope ts("verify copy", "transfer");
+                #pragma acc update host(accImgGrid_d[0:gSize*gSize])
+                saveSample(accImgGrid, acclmGrid, verifyStride);
+            }
 #endif
         }
 
         //-------------------------------------------------------------------//
         // Do Hogbom CLEAN
 
-        std::vector<std::complex<float> > accModelGrid(accPsfGrid.size());
-        accModelGrid.assign(accModelGrid.size(), std::complex<float>(0.0));
-
+        accModelComps.clear();
         {
+            mem.beginStage();
             Stopwatch sw;
             sw.start();
-            deconvolveACC(accImgGrid, gSize, accPsfGrid, gSize, accModelGrid, nMinor);
+            const uint64_t traceStart = Trace::now();
+            const int nIter = (maxIter > 0) ? std::min(nMinor, maxIter - accIters) : nMinor;
+            const int nDone = deconvolveACC(accImgGrid, gSize, accPsfGrid, gSize, accModelComps,
+                                            nIter, threshold, cycleFactor * accSidelobe, accPeak);
+            accIters += nDone;
             HogbomAccTimer += sw.stop();
+            Trace::complete("clean", "acc", traceStart);
+            mem.endStage("acc clean");
+            cout << "    minor cycles (acc): " << nDone << ", peak residual " << accPeak << endl;
         }
 
 #ifdef RUN_VERIFY
         // Save a copy for varification
-        #pragma acc update host(accImgGrid_d[0:gSize*gSize])
-        acclmRes = accImgGrid;
+        {
+            TraceScope ts("verify copy", "transfer");
+            #pragma acc update host(accImgGrid_d[0:gSize*gSize])
+            saveSample(accImgGrid, acclmRes, verifyStride);
+        }
 #endif
 
-        accImgGrid = accModelGrid;
-        #pragma acc update device(accImgGrid_d[0:gSize*gSize])
+        {
+            TraceScope ts("model image", "acc");
+            modelImageACC(accModelComps, accImgGrid);
+        }
+#ifdef RUN_VERIFY
+        {
+            TraceScope ts("verify copy", "transfer");
+            #pragma acc update host(accImgGrid_d[0:gSize*gSize])
+            saveSample(accImgGrid, acclmModel, verifyStride);
+        }
+#endif
 
         //-------------------------------------------------------------------//
         // FFT deconvolved model image for degridding
         {
+            mem.beginStage();
             Stopwatch sw;
             sw.start();
+            const uint64_t traceStart = Trace::now();
             #ifdef GPU
             // Use CUFFT
             if ( fftExecGPU(accImgGrid, gSize, true) != 0 ) {
@@ -1333,25 +1750,36 @@ int main(int argc, char* argv[])
             }
             #endif
             fftAccTimer += sw.stop();
+            Trace::complete("forward fft", "acc", traceStart);
+            mem.endStage("acc forward fft");
         }
 
         //-------------------------------------------------------------------//
         // DO DEGRIDDING
         {
             // Time is measured inside this function call, unlike the CPU versions
+            mem.beginStage();
             Stopwatch sw;
             sw.start();
+            const uint64_t traceStart = Trace::now();
             degridKernelACC(accImgGrid, gSize, support, C, cOffset, iu, iv, accModel);
             degridAccTimer += sw.stop();
+            Trace::complete("degrid", "acc", traceStart);
+            mem.endStage("acc degrid");
         }
 
         //-------------------------------------------------------------------//
         // Copy GPU data back to CPU
 
         //#pragma acc exit data copyout(accImgGrid_d[0:gSize*gSize],accModel_d[0:nSamples*nChan]) 
-        #pragma acc update host(accImgGrid_d[0:gSize*gSize],accModel_d[0:nSamples*nChan])
+        {
+            TraceScope ts("results to host", "transfer");
+            #pragma acc update host(accImgGrid_d[0:gSize*gSize],accModel_d[0:nSamples*nChan])
+        }
 
         double acc_time = sw_acc.stop();
+        accConvergeTime += acc_time;
+        Trace::complete("major cycle", "acc", accTraceStart);
         cout << "    time " << acc_time << " (s)" << endl;
 
 #ifdef RUN_VERIFY
@@ -1360,15 +1788,15 @@ int main(int argc, char* argv[])
         // Verify results
         ///////////////////////////////////////////////////////////////////////
         cout << "    verifying:";
+        const uint64_t verifyTraceStart = Trace::now();
 
         // store the location and value of the maximum PSF pixel to normalise everything by
         std::vector<std::complex<float> >::iterator maxLoc;
         int maxPixel;
         if (it_major == 0)
         {
-            maxLoc = std::max_element(cpulmPsf.begin(), cpulmPsf.end(), abs_compare);
-            maxPixel = std::distance(cpulmPsf.begin(), maxLoc);
-            psfScale = 1.0 / fabs(cpulmPsf[maxPixel].real());
+            maxLoc = std::max_element(cpuPsfGrid.begin(), cpuPsfGrid.end(), abs_compare);
+            psfScale = 1.0 / fabs(maxLoc->real());
         }
 
         // set a threshold factor
@@ -1392,7 +1820,7 @@ int main(int argc, char* argv[])
             for (unsigned int i = 0; i < cpuuvPsf.size(); ++i) {
                 if (fabs(cpuuvPsf[i].real() - accuvPsf[i].real()) / fabs(cpuuvPsf[maxPixel].real()) > thresh) {
                     cout << "Fail (Expected " << cpuuvPsf[i].real() << " got "
-                             << accuvPsf[i].real() << " at index " << i << ")"
+                             << accuvPsf[i].real() << " at index " << i*verifyStride << ")"
                              << endl;
                     return 1;
                 }
@@ -1414,7 +1842,7 @@ int main(int argc, char* argv[])
             if (fabs(cpuuvGrid[i].real() - accuvGrid[i].real()) / fabs(cpuuvGrid[maxPixel].real()) > thresh) {
                 cout << endl;
                 cout << "Fail (Expected " << cpuuvGrid[i].real() << " got "
-                         << accuvGrid[i].real() << " at index " << i << ")"
+                         << accuvGrid[i].real() << " at index " << i*verifyStride << ")"
                          << endl;
                 return 1;
             }
@@ -1434,7 +1862,7 @@ int main(int argc, char* argv[])
             if (fabs(cpulmPsf[i].real() - acclmPsf[i].real()) * psfScale > thresh) {
                 cout << endl;
                 cout << "Fail for PSF (Expected " << cpulmPsf[i].real() << " got "
-                         << acclmPsf[i].real() << " at index " << i << ")"
+                         << acclmPsf[i].real() << " at index " << i*verifyStride << ")"
                          << endl;
                 return 1;
             }
@@ -1450,12 +1878,18 @@ int main(int argc, char* argv[])
             if (fabs(cpulmGrid[i].real() - acclmGrid[i].real()) * psfScale > thresh) {
                 cout << endl;
                 cout << "Fail for dirty image (Expected " << cpulmGrid[i].real() << " got "
-                         << acclmGrid[i].real() << " at index " << i << ")"
+                         << acclmGrid[i].real() << " at index " << i*verifyStride << ")"
                          << endl;
                 return 1;
             }
         }
 
+        if (it_major == 0) {
+            // the PSF is only gridded once
+            freeSample(cpuuvPsf);
+            freeSample(accuvPsf);
+        }
+
         //-------------------------------------------------------------------//
         // Verify Hogbom clean results
         cout << " clean";
@@ -1470,23 +1904,23 @@ int main(int argc, char* argv[])
             if (fabs(cpulmRes[i].real() - acclmRes[i].real()) * psfScale > thresh) {
                 cout << endl;
                 cout << "Fail for residual (Expected " << cpulmRes[i].real() << " got "
-                         << acclmRes[i].real() << " at index " << i << ")"
+                         << acclmRes[i].real() << " at index " << i*verifyStride << ")"
                          << endl;
                 return 1;
             }
         }
 
-        if (cpuModelGrid.size() != accModelGrid.size()) {
+        if (cpulmModel.size() != acclmModel.size()) {
             cout << endl;
             cout << "Fail (Model grid sizes differ)" << endl;
             return 1;
         }
 
-        for (unsigned int i = 0; i < cpuModelGrid.size(); ++i) {
-            if (fabs(cpuModelGrid[i].real() - accModelGrid[i].real()) * psfScale > thresh) {
+        for (unsigned int i = 0; i < cpulmModel.size(); ++i) {
+            if (fabs(cpulmModel[i].real() - acclmModel[i].real()) * psfScale > thresh) {
                 cout << endl;
-                cout << "Fail for model (Expected " << cpuModelGrid[i].real() << " got "
-                         << accModelGrid[i].real() << " at index " << i << ")"
+                cout << "Fail for model (Expected " << cpulmModel[i].real() << " got "
+                         << acclmModel[i].real() << " at index " << i*verifyStride << ")"
                          << endl;
                 return 1;
             }
@@ -1502,7 +1936,7 @@ int main(int argc, char* argv[])
             return 1;
         }
 
-        for (unsigned int i = 0; i < cpuImgGrid.size(); ++i) {
+        for (unsigned int i = 0; i < cpuImgGrid.size(); i += verifyStride) {
             if (fabs(cpuImgGrid[i].real() - accImgGrid[i].real()) * psfScale > thresh) {
                 cout << endl;
                 cout << "Fail (Expected " << cpuImgGrid[i].real() << " got "
@@ -1532,6 +1966,7 @@ int main(int argc, char* argv[])
             }
         }
 
+        Trace::complete("verify", "verify", verifyTraceStart);
         cout << ": pass" << endl;
 
 #endif
@@ -1545,14 +1980,31 @@ int main(int argc, char* argv[])
 
 #ifdef RUN_CPU
         // subtract the model vis and cycle back
-        for (unsigned int i = 0; i < nSamples*nChan; ++i) {
-            cpuData[i] = cpuData[i] - cpuModel[i];
+        {
+            TraceScope ts("subtract model", "cpu");
+            for (unsigned int i = 0; i < nSamples*nChan; ++i) {
+                cpuData[i] = cpuData[i] - cpuModel[i];
+            }
         }
 #endif
 
-        #pragma acc parallel loop present(accData_d[0:nSamples*nChan],accModel_d[0:nSamples*nChan])
-        for (unsigned int i = 0; i < nSamples*nChan; ++i) {
-            accData_d[i] = accData_d[i] - accModel_d[i];
+        {
+            TraceScope ts("subtract model", "acc");
+            #pragma acc parallel loop present(accData_d[0:nSamples*nChan],accModel_d[0:nSamples*nChan])
+            for (unsigned int i = 0; i < nSamples*nChan; ++i) {
+                accData_d[i] = accData_d[i] - accModel_d[i];
+            }
+        }
+
+        // The OpenACC version decides when to stop. Reaching the global
+        // threshold still needs this cycle's model subtracted, which is done.
+        nCycles++;
+        if (abs(accPeak) < threshold) {
+            converged = true;
+            break;
+        }
+        if ((maxIter > 0) && (accIters >= maxIter)) {
+            break;
         }
 
     } // it_major
@@ -1563,6 +2015,26 @@ int main(int argc, char* argv[])
 
     double time;
 
+    cout << endl << "+++++ Convergence +++++" << endl << endl;
+    cout << "Major cycles " << nCycles << " of " << nMajor;
+    if (converged) {
+        cout << ", reached threshold " << threshold << endl;
+    } else if ((maxIter > 0) && (accIters >= maxIter)) {
+        cout << ", reached iteration limit " << maxIter << endl;
+    } else {
+        cout << ", did not converge" << endl;
+    }
+#ifdef RUN_CPU
+    cout << "CPU single core" << endl;
+    cout << "    Minor cycle iterations " << cpuIters << endl;
+    cout << "    Final peak residual " << cpuPeak << endl;
+    cout << "    Time to convergence " << cpuConvergeTime << " (s)" << endl;
+#endif
+    cout << "OpenACC" << endl;
+    cout << "    Minor cycle iterations " << accIters << endl;
+    cout << "    Final peak residual " << accPeak << endl;
+    cout << "    Time to convergence " << accConvergeTime << " (s)" << endl;
+
 #ifdef RUN_CPU
     cout << endl << "+++++ CPU single core times +++++" << endl << endl;
     time = psfCpuTimer; // Only done once, during the first major cycle
@@ -1571,24 +2043,26 @@ int main(int argc, char* argv[])
     cout << "    Time per visibility sample " << 1e6*time / double(cpuData.size()) << " (us) " << endl;
     cout << "    Time per gridding   " << 1e9*time / double(cpuData.size()*sSize*sSize) << " (ns) " << endl;
     cout << "    Gridding rate   " << griddings/1e6/time << " (million grid points per second)" << endl;
-    time = imgCpuTimer/double(nMajor);
+    time = imgCpuTimer/double(nCycles);
     cout << "Gridding data" << endl;
     cout << "    Time per major cycle " << time << " (s) " << endl;
     cout << "    Time per visibility sample " << 1e6*time / double(cpuData.size()) << " (us) " << endl;
     cout << "    Time per gridding   " << 1e9*time / double(cpuData.size()*sSize*sSize) << " (ns) " << endl;
     cout << "    Gridding rate   " << griddings/1e6/time << " (million grid points per second)" << endl;
-    time = ifftCpuTimer/double(nMajor);
+    time = ifftCpuTimer/double(nCycles);
     cout << "Inverse FFTs" << endl;
     cout << "    Time per major cycle " << time << " (s) " << endl;
-    time = HogbomCpuTimer/double(nMajor);
+    time = HogbomCpuTimer/double(nCycles);
     cout << "Hogbom clean" << endl;
     cout << "    Time per major cycle " << time << " (s) " << endl;
-    cout << "    Time per minor cycle " << time / nMinor * 1000 << " (ms)" << endl;
-    cout << "    Cleaning rate  " << nMinor / time << " (iterations per second)" << endl;
-    time = fftCpuTimer/double(nMajor);
+    if (cpuIters > 0) {
+        cout << "    Time per minor cycle " << HogbomCpuTimer / cpuIters * 1000 << " (ms)" << endl;
+        cout << "    Cleaning rate  " << cpuIters / HogbomCpuTimer << " (iterations per second)" << endl;
+    }
+    time = fftCpuTimer/double(nCycles);
     cout << "Forward FFT" << endl;
     cout << "    Time per major cycle " << time << " (s) " << endl;
-    time = degridCpuTimer/double(nMajor);
+    time = degridCpuTimer/double(nCycles);
     cout << "Degridding data" << endl;
     cout << "    Time per major cycle " << time << " (s) " << endl;
     cout << "    Time per visibility sample " << 1e6*time / double(cpuData.size()) << " (us) " << endl;
@@ -1602,30 +2076,54 @@ int main(int argc, char* argv[])
     cout << "    Time per visibility sample " << 1e6*time / double(accData.size()) << " (us) " << endl;
     cout << "    Time per gridding   " << 1e9*time / double(accData.size()*sSize*sSize) << " (ns) " << endl;
     cout << "    Gridding rate   " << griddings/1e6/time << " (million grid points per second)" << endl;
-    time = imgAccTimer/double(nMajor);
+    time = imgAccTimer/double(nCycles);
     cout << "Gridding data" << endl;
     cout << "    Time per major cycle " << time << " (s) " << endl;
     cout << "    Time per visibility sample " << 1e6*time / double(accData.size()) << " (us) " << endl;
     cout << "    Time per gridding   " << 1e9*time / double(accData.size()*sSize*sSize) << " (ns) " << endl;
     cout << "    Gridding rate   " << griddings/1e6/time << " (million grid points per second)" << endl;
-    time = ifftAccTimer/double(nMajor);
+    time = ifftAccTimer/double(nCycles);
     cout << "Inverse FFTs" << endl;
     cout << "    Time per major cycle " << time << " (s) " << endl;
-    time = HogbomAccTimer/double(nMajor);
+    time = HogbomAccTimer/double(nCycles);
     cout << "Hogbom clean" << endl;
     cout << "    Time per major cycle " << time << " (s) " << endl;
-    cout << "    Time per minor cycle " << time / nMinor * 1000 << " (ms)" << endl;
-    cout << "    Cleaning rate  " << nMinor / time << " (iterations per second)" << endl;
-    time = fftAccTimer/double(nMajor);
+    if (accIters > 0) {
+        cout << "    Time per minor cycle " << HogbomAccTimer / accIters * 1000 << " (ms)" << endl;
+        cout << "    Cleaning rate  " << accIters / HogbomAccTimer << " (iterations per second)" << endl;
+    }
+    time = fftAccTimer/double(nCycles);
     cout << "Forward FFT" << endl;
     cout << "    Time per major cycle " << time << " (s) " << endl;
-    time = degridAccTimer/double(nMajor);
+    time = degridAccTimer/double(nCycles);
     cout << "Degridding data" << endl;
     cout << "    Time per major cycle " << time << " (s) " << endl;
     cout << "    Time per visibility sample " << 1e6*time / double(accData.size()) << " (us) " << endl;
     cout << "    Time per degridding   " << 1e9*time / double(accData.size()*sSize*sSize) << " (ns) " << endl;
     cout << "    Degridding rate   " << griddings/1e6/time << " (million grid points per second)" << endl;
 
+    cout << endl << "+++++ Memory +++++" << endl << endl;
+    cout << "Grid pool" << endl;
+    cout << "    Grid size " << pool.gridBytes() / (1024.0*1024.0) << " (MB)" << endl;
+    cout << "    Grids allocated " << pool.allocations() << ", reused " << pool.reuses() << endl;
+    cout << "    Peak in use " << pool.peakBytesInUse() / (1024.0*1024.0) << " (MB)" << endl;
+    mem.addStructure("C", C);
+    mem.addStructure("grids", pool.allocations() * pool.gridBytes());
+    mem.addStructure("uvw", u);
+    mem.addStructure("uvw", v);
+    mem.addStructure("uvw", w);
+    mem.addStructure("indices", iu);
+    mem.addStructure("indices", iv);
+    mem.addStructure("indices", cOffset);
+    mem.addStructure("data", visData);
+#ifdef RUN_CPU
+    mem.addStructure("data", cpuData);
+    mem.addStructure("data", cpuModel);
+#endif
+    mem.addStructure("data", accData);
+    mem.addStructure("data", accModel);
+    mem.report(cout);
+
     cout << endl;
 
     //writeImage("dirty_cpu.img", cpulmPsf);